@@ -10,7 +10,7 @@ if %errorlevel% neq 0 (
 )
 
 set CXX=g++
-set CXXFLAGS=-std=c++17 -Iinclude
+set CXXFLAGS=-std=c++17 -Iinclude -pthread
 set OUTDIR=build
 
 rem Create build directory if it doesn't exist
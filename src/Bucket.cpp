@@ -1,5 +1,7 @@
 #include "Bucket.hpp"
+#include "CountedValue.hpp"
 #include <iostream>
+#include <algorithm>
 
 template <typename T>
 void Bucket<T>::display() const {
@@ -28,6 +30,7 @@ std::optional<T> Bucket<T>::find(const uint32_t key) const {
     // TODO 3
     for (const auto& item : items) {
         if (item.isValid() && item.getKey() == key) {
+            item.markReferenced();
             return item.getData();
         }
     }
@@ -37,6 +40,46 @@ std::optional<T> Bucket<T>::find(const uint32_t key) const {
     return std::nullopt;
 }
 
+/**
+ * @brief Returns a pointer to the data associated with the given key.
+ *
+ * Unlike find, the lookup neither copies the data nor sets the reference bit,
+ * so it is safe on buckets shared with snapshots read by other threads.
+ *
+ * @param key The key to search for in the bucket.
+ * @return A pointer to the data, valid until the item is modified, or nullptr if not found.
+ */
+template <typename T>
+const T* Bucket<T>::get(const uint32_t key) const {
+    for (const auto& item : items) {
+        if (item.isValid() && item.getKey() == key) {
+            return &item.data;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Copies the bucket, slot layout, reference bits, clock hand and overflow count included.
+ *
+ * @tparam T The type of items stored in the bucket.
+ * @param epoch The snapshot epoch stamped on the copy.
+ * @return A new bucket holding the same items.
+ */
+template <typename T>
+std::shared_ptr<Bucket<T>> Bucket<T>::clone(const uint32_t epoch) const {
+    std::shared_ptr<Bucket> copy = make(localDepth, epoch);
+    for (size_t i = 0; i < items.size(); i++) {
+        if (items[i].isValid()) {
+            copy->items[i] = DataItem<T>(items[i].key, items[i].data);
+            copy->items[i].copyReferenced(items[i]);
+        }
+    }
+    copy->validEntryCount = validEntryCount;
+    copy->clockHand = clockHand;
+    copy->overflowCount = overflowCount;
+    return copy;
+}
 
 /**
  * @brief Writes a data item into the bucket.
@@ -54,17 +97,45 @@ std::optional<T> Bucket<T>::find(const uint32_t key) const {
 template <typename T>
 bool Bucket<T>::write(const uint32_t key, const T& data) {
     // TODO 1
+    return store(key, data);
+}
 
-    if (validEntryCount == BUCKET_CAPACITY) return false;
+/**
+ * @brief Moves a data item into the bucket.
+ *
+ * Behaves like the copying overload, but the data is moved into the free slot.
+ * If the bucket is full, data is left untouched so the caller can retry elsewhere.
+ *
+ * @tparam T The type of the data item to be written.
+ * @param key The key associated with the data item.
+ * @param data The data item to be moved into the bucket.
+ * @return true if the data item was successfully written into the bucket, false if the bucket is full.
+ */
+template <typename T>
+bool Bucket<T>::write(const uint32_t key, T&& data) {
+    return store(key, std::move(data));
+}
 
+/**
+ * @brief Replaces the data of an existing item in place.
+ *
+ * The item keeps its slot and is marked as recently used. If the key is not in
+ * the bucket, data is left untouched.
+ *
+ * @tparam T The type of the data item to be written.
+ * @param key The key of the item to update.
+ * @param data The new data, moved into the slot.
+ * @return true if the item was found and updated, false otherwise.
+ */
+template <typename T>
+bool Bucket<T>::update(const uint32_t key, T&& data) {
     for (auto& item : items) {
-        if (!item.isValid()) {
-            item = DataItem<T>(key, data);
-            validEntryCount++;
+        if (item.isValid() && item.getKey() == key) {
+            item.data = std::move(data);
+            item.markReferenced();
             return true;
         }
     }
-
     return false;
 }
 
@@ -97,4 +168,96 @@ bool Bucket<T>::erase(const uint32_t key) {
     return false;
 }
 
-template class Bucket<int>;
\ No newline at end of file
+/**
+ * @brief Moves the data out of a slot and erases the slot.
+ *
+ * Used to rehash the items of a bucket that is being discarded without copying them.
+ *
+ * @tparam T The type of items stored in the bucket.
+ * @param slot The index of a valid slot.
+ * @return The data that was stored in the slot.
+ */
+template <typename T>
+T Bucket<T>::take(const size_t slot) {
+    items[slot].markInvalid();
+    validEntryCount--;
+    return std::move(items[slot].data);
+}
+
+/**
+ * @brief Evicts one item from the bucket using the CLOCK policy.
+ *
+ * The clock hand sweeps the slots of the bucket. A valid item whose reference bit
+ * is set gets a second chance: the bit is cleared and the hand moves on. The first
+ * valid item found without its reference bit is erased. Two sweeps are enough to
+ * find a victim, since the first one clears every reference bit.
+ *
+ * @tparam T The type of items stored in the bucket.
+ * @return true if an item was evicted, false if the bucket is empty.
+ */
+template <typename T>
+bool Bucket<T>::evict() {
+    if (validEntryCount == 0) return false;
+
+    for (uint32_t step = 0; step < 2 * BUCKET_CAPACITY; step++) {
+        auto& item = items[clockHand];
+        clockHand = (clockHand + 1) % BUCKET_CAPACITY;
+        if (!item.isValid()) continue;
+        if (item.isReferenced()) {
+            item.clearReferenced();
+            continue;
+        }
+        item.markInvalid();
+        validEntryCount--;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Visits every valid item of the bucket in slot order.
+ *
+ * @tparam T The type of items stored in the bucket.
+ * @param callback Invoked with the key and data of every valid item.
+ */
+template <typename T>
+void Bucket<T>::forEach(const std::function<void(uint32_t, const T&)>& callback) const {
+    for (const auto& item : items) {
+        if (item.isValid()) {
+            callback(item.key, item.data);
+        }
+    }
+}
+
+/**
+ * @brief Visits the items of the bucket whose keys fall in [lo, hi] in ascending key order.
+ *
+ * Items inside a bucket are stored in insertion order, so the matching items are
+ * collected and sorted by key before the callback is invoked on each of them.
+ *
+ * @tparam T The type of items stored in the bucket.
+ * @param lo The smallest key to visit (inclusive).
+ * @param hi The largest key to visit (inclusive).
+ * @param callback Invoked with the key and data of every matching item.
+ */
+template <typename T>
+void Bucket<T>::scan(const uint32_t lo, const uint32_t hi, const std::function<void(uint32_t, const T&)>& callback) const {
+    std::array<const DataItem<T>*, BUCKET_CAPACITY> matches;
+    size_t count = 0;
+    for (const auto& item : items) {
+        if (item.isValid() && item.getKey() >= lo && item.getKey() <= hi) {
+            matches[count++] = &item;
+        }
+    }
+
+    std::sort(matches.begin(), matches.begin() + count,
+              [](const DataItem<T>* a, const DataItem<T>* b) { return a->getKey() < b->getKey(); });
+
+    for (size_t i = 0; i < count; i++) {
+        callback(matches[i]->getKey(), matches[i]->data);
+    }
+}
+
+template class Bucket<int>;
+template class Bucket<CountedValue>;
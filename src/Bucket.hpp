@@ -1,28 +1,81 @@
 #pragma once
 #include <optional>
 #include <array>
+#include <functional>
+#include <memory>
 
 #include "DataItem.hpp"
 #include "Common.hpp"
+#include "HugePageAllocator.hpp"
 
 template<typename T>
 class Bucket {
 public:
     Bucket() : localDepth(0), validEntryCount(0) {}
-    Bucket(const uint32_t localDepth) : localDepth(localDepth), validEntryCount(0) {}
+    Bucket(const uint32_t localDepth, const uint32_t epoch = 0) : localDepth(localDepth), validEntryCount(0), epoch(epoch) {}
+
+    // Buckets are allocated through HugePageArena so that they follow the configured page mode
+    static std::shared_ptr<Bucket> make(const uint32_t localDepth = 0, const uint32_t epoch = 0) {
+        return std::allocate_shared<Bucket>(HugePageAllocator<Bucket>(), localDepth, epoch);
+    }
+
+    // Copy taken before modifying a bucket that a snapshot may still read
+    std::shared_ptr<Bucket> clone(const uint32_t epoch) const;
 
     uint8_t getLocalDepth() const { return localDepth; }
     uint32_t getEntryCount() const { return validEntryCount; }
+    uint32_t getEpoch() const { return epoch; }
+    // Entries whose home is this bucket but which overflowed into the stash (balanced mode)
+    uint32_t getOverflowCount() const { return overflowCount; }
+    void setOverflowCount(const uint32_t count) { overflowCount = count; }
     const std::array<DataItem<T>, BUCKET_CAPACITY>& getItems() const { return items; }
 
     bool write(const uint32_t key, const T& data);
+    bool write(const uint32_t key, T&& data);
+    bool update(const uint32_t key, T&& data);
     bool erase(const uint32_t key);
+    bool evict();
+    T take(const size_t slot);
 
     void display() const;
     std::optional<T> find(const uint32_t key) const;
+    const T* get(const uint32_t key) const;
+
+    // Calls visitor with the data of the key in place and marks it as recently used
+    template <typename Visitor>
+    bool visit(const uint32_t key, Visitor&& visitor) const {
+        for (const auto& item : items) {
+            if (item.isValid() && item.getKey() == key) {
+                item.markReferenced();
+                visitor(item.getData());
+                return true;
+            }
+        }
+        return false;
+    }
+    void forEach(const std::function<void(uint32_t, const T&)>& callback) const;
+    void scan(const uint32_t lo, const uint32_t hi, const std::function<void(uint32_t, const T&)>& callback) const;
 
 private:
+    // Copies or moves data into a free slot, data is left untouched if the bucket is full
+    template <typename U>
+    bool store(const uint32_t key, U&& data) {
+        if (validEntryCount == BUCKET_CAPACITY) return false;
+
+        for (auto& item : items) {
+            if (!item.isValid()) {
+                item.assign(key, std::forward<U>(data));
+                validEntryCount++;
+                return true;
+            }
+        }
+        return false;
+    }
+
     uint8_t localDepth{ 0 };       // Default initialization for localDepth
     uint32_t validEntryCount{ 0 };  // Default initialization for validEntryCount
+    uint32_t clockHand{ 0 };        // Next slot inspected by evict()
+    uint32_t epoch{ 0 };            // Snapshot epoch of the directory when the bucket was created
+    uint32_t overflowCount{ 0 };    // Stash entries homed here, the stash is only probed when non-zero
     std::array<DataItem<T>, BUCKET_CAPACITY> items;
 };
@@ -4,11 +4,18 @@
 #include "MemoryManager.hpp"
 #include "Bucket.hpp"
 #include <assert.h>
+#include <iostream>
 
 enum class CommandType {
     WRITE,
     ERASE,
     SEARCH,
+    SCAN,
+    AGGREGATE,
+    FREEZE,
+    SNAPSHOT,
+    CACHE_MODE,
+    CACHE_STATS,
     DISPLAY
 };
 
@@ -92,4 +99,145 @@ public:
         bool result = manager.searchAndPrint(key);
         assert(result == this->expected);
     }
+};
+
+// Scan Command
+template <typename T>
+class ScanCommand : public Command<T> {
+public:
+    const uint32_t lo;
+    const uint32_t hi;
+    const size_t expectedCount;
+
+    ScanCommand(uint32_t lo, uint32_t hi, size_t expectedCount)
+        : Command<T>(CommandType::SCAN), lo(lo), hi(hi), expectedCount(expectedCount) {}
+
+    void execute(MemoryManager<T>& manager) const override {
+        size_t count = 0;
+        uint32_t previousKey = 0;
+        std::cout << "Scan [" << lo << ", " << hi << "]:";
+        manager.scan(lo, hi, [&](uint32_t key, const T& data) {
+            assert(count == 0 || previousKey <= key);
+            std::cout << " " << key << "=" << data;
+            previousKey = key;
+            count++;
+        });
+        std::cout << std::endl;
+        assert(count == expectedCount);
+    }
+};
+
+// Aggregate Command
+template <typename T>
+class AggregateCommand : public Command<T> {
+public:
+    const size_t expectedCount;
+    const size_t threads;
+
+    AggregateCommand(size_t expectedCount, size_t threads = 0)
+        : Command<T>(CommandType::AGGREGATE), expectedCount(expectedCount), threads(threads) {}
+
+    void execute(MemoryManager<T>& manager) const override {
+        using Summary = std::pair<size_t, uint64_t>; // entry count, key sum
+        Summary summary = manager.reduce(Summary{ 0, 0 },
+            [](uint32_t key, const T&) { return Summary{ 1, key }; },
+            [](Summary a, Summary b) { return Summary{ a.first + b.first, a.second + b.second }; },
+            threads);
+
+        uint64_t expectedSum = 0;
+        manager.scan(0, MAX_KEY_VALUE, [&](uint32_t key, const T&) { expectedSum += key; });
+
+        std::cout << "Aggregate: " << summary.first << " entries, key sum " << summary.second << std::endl;
+        assert(summary.first == expectedCount);
+        assert(summary.second == expectedSum);
+    }
+};
+
+// Freeze Command: checks the frozen copy against the live table
+template <typename T>
+class FreezeCommand : public Command<T> {
+public:
+    const size_t expectedCount;
+
+    FreezeCommand(size_t expectedCount) : Command<T>(CommandType::FREEZE), expectedCount(expectedCount) {}
+
+    void execute(MemoryManager<T>& manager) const override {
+        const FrozenTable<T> frozen = manager.freeze();
+        std::cout << "Freeze: " << frozen.size() << " entries, depth " << (uint32_t)frozen.getDepth()
+                  << ", " << frozen.getMemoryUsage() << " bytes" << std::endl;
+        assert(frozen.size() == expectedCount);
+
+        // Compared through scan, since find would count hits and set reference bits
+        size_t matched = 0;
+        manager.scan(0, MAX_KEY_VALUE, [&](uint32_t key, const T& data) {
+            const T* frozenData = frozen.get(key);
+            assert(frozenData && *frozenData == data);
+            matched++;
+        });
+        assert(matched == frozen.size());
+    }
+};
+
+// Snapshot Command: writes and erases a key behind a snapshot of the table,
+// checking that the snapshot keeps its contents while the live table changes.
+// Needs GlobalDirectory, like MemoryManager::snapshot.
+template <typename T>
+class SnapshotCommand : public Command<T> {
+public:
+    const uint32_t key;
+    const T data;
+
+    SnapshotCommand(uint32_t key, T data) : Command<T>(CommandType::SNAPSHOT), key(key), data(data) {}
+
+    void execute(MemoryManager<T>& manager) const override {
+        const auto snapshot = manager.snapshot();
+        const FrozenTable<T> before = snapshot.freeze();
+
+        const bool written = manager.write(key, data);
+        std::cout << "Snapshot: " << before.size() << " entries, key " << key
+                  << (written ? " written" : " not written") << " behind it" << std::endl;
+        // Checked through scan, since find would count hits and set reference bits
+        bool live = false;
+        manager.scan(key, key, [&live](uint32_t, const T&) { live = true; });
+        assert(written && live && !snapshot.get(key));
+        const bool erased = manager.erase(key);
+        assert(erased);
+
+        size_t matched = 0;
+        snapshot.scan(0, MAX_KEY_VALUE, [&](uint32_t key, const T& data) {
+            assert(before.get(key) && *before.get(key) == data);
+            matched++;
+        });
+        assert(matched == before.size());
+    }
+};
+
+// Cache Mode Command: pins the memory budget to the current usage
+template <typename T>
+class CacheModeCommand : public Command<T> {
+public:
+    CacheModeCommand() : Command<T>(CommandType::CACHE_MODE) {}
+
+    void execute(MemoryManager<T>& manager) const override {
+        manager.enableCacheMode(manager.getMemoryUsage());
+    }
+};
+
+// Cache Stats Command
+template <typename T>
+class CacheStatsCommand : public Command<T> {
+public:
+    const size_t expectedEvictions;
+
+    CacheStatsCommand(size_t expectedEvictions)
+        : Command<T>(CommandType::CACHE_STATS), expectedEvictions(expectedEvictions) {}
+
+    void execute(MemoryManager<T>& manager) const override {
+        CacheStats stats = manager.getCacheStats();
+        std::cout << "Cache: hits " << stats.hits << ", misses " << stats.misses
+                  << ", hit rate " << stats.hitRate() << ", evictions " << stats.evictions
+                  << ", memory " << stats.memoryUsage << "/" << stats.memoryBudget << " bytes" << std::endl;
+        assert(stats.evictions == expectedEvictions);
+        assert(stats.memoryUsage <= stats.memoryBudget);
+    }
 };
\ No newline at end of file
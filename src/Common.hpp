@@ -1,6 +1,28 @@
 #pragma once
 #include <cstdint>
 
+// Overridable from the compiler command line, e.g. -DMAX_KEY_LENGTH=24u for benchmarks
+#ifndef BUCKET_CAPACITY
 #define BUCKET_CAPACITY (uint32_t)2
+#endif
+#ifndef MAX_KEY_LENGTH
 #define MAX_KEY_LENGTH (uint32_t)8
+#endif
 #define MAX_KEY_VALUE (uint32_t)((1<<(MAX_KEY_LENGTH))-1)
+
+// Overflow buckets of GlobalDirectory in balanced insertion mode: the stash starts with
+// 2^STASH_MIN_DEPTH buckets and keeps one bucket per 2^STASH_SPAN_BITS directory slots
+#define STASH_MIN_DEPTH (uint32_t)1
+#ifndef STASH_SPAN_BITS
+#define STASH_SPAN_BITS (uint32_t)4
+#endif
+
+// Slots per segment of the GlobalDirectory array: the first write after a snapshot copies
+// the segment list and the segments it touches, never the whole array
+#ifndef DIRECTORY_SEGMENT_BITS
+#define DIRECTORY_SEGMENT_BITS (uint32_t)10
+#endif
+
+// Key bits consumed by each node of RadixDirectory
+#define RADIX_STRIDE (uint32_t)4
+#define RADIX_LEVELS ((MAX_KEY_LENGTH + RADIX_STRIDE - 1) / RADIX_STRIDE)
@@ -0,0 +1,53 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+/**
+ * @class CountedValue
+ * @brief A heap-backed value type that counts how often it is copied and moved.
+ *
+ * The table templates are instantiated for it next to int, so that the copy-free paths
+ * (write and update with an rvalue, visit, get, splits and merges) can be checked
+ * against a type whose copies are visible and cost an allocation, see bench/CopyBenchmark.cpp.
+ */
+class CountedValue {
+public:
+    CountedValue() = default;
+    explicit CountedValue(const int value) : value(value), payload(PAYLOAD_SIZE, 'x') {}
+
+    CountedValue(const CountedValue& other) : value(other.value), payload(other.payload) { copies++; }
+    CountedValue(CountedValue&& other) noexcept : value(other.value), payload(std::move(other.payload)) { moves++; }
+
+    CountedValue& operator=(const CountedValue& other) {
+        value = other.value;
+        payload = other.payload;
+        copies++;
+        return *this;
+    }
+
+    CountedValue& operator=(CountedValue&& other) noexcept {
+        value = other.value;
+        payload = std::move(other.payload);
+        moves++;
+        return *this;
+    }
+
+    int getValue() const { return value; }
+    bool operator==(const CountedValue& other) const { return value == other.value; }
+
+    static size_t getCopies() { return copies; }
+    static size_t getMoves() { return moves; }
+
+    friend std::ostream& operator<<(std::ostream& out, const CountedValue& counted) { return out << counted.value; }
+
+private:
+    static constexpr size_t PAYLOAD_SIZE = 64;  // past the small string buffer, so a copy allocates
+
+    int value{ 0 };
+    std::string payload;
+
+    static inline std::atomic<size_t> copies{ 0 };
+    static inline std::atomic<size_t> moves{ 0 };
+};
@@ -1,6 +1,8 @@
 #pragma once
 #include <array>
+#include <atomic>
 #include <utility>
+#include <type_traits>
 #include <iostream>
 
 #include "Common.hpp"
@@ -23,6 +25,7 @@ public:
     // Move Constructor
     DataItem(DataItem&& other) noexcept
         : valid(std::move(other.valid)),
+        referenced(other.referenced.load(std::memory_order_relaxed)),
         data(std::move(other.data)),
         key(std::move(other.key)) {
         other.valid = false; // Invalidate the moved-from object
@@ -32,6 +35,7 @@ public:
     DataItem& operator=(DataItem&& other) noexcept {
         if (this != &other) {
             valid = std::move(other.valid);
+            referenced.store(other.referenced.load(std::memory_order_relaxed), std::memory_order_relaxed);
             data = std::move(other.data);
             key = std::move(other.key);
             other.valid = false; // Invalidate the moved-from object
@@ -42,6 +46,16 @@ public:
     void markInvalid() { valid = false; }
     void markValid() { valid = true; }
 
+    // Reference bit for CLOCK eviction in cache mode, set by lookups. Relaxed atomic so that
+    // concurrent lookups of the same entry may mark it; only set when clear to keep hits read-only.
+    void markReferenced() const {
+        if (!referenced.load(std::memory_order_relaxed)) referenced.store(true, std::memory_order_relaxed);
+    }
+    void clearReferenced() { referenced.store(false, std::memory_order_relaxed); }
+    void copyReferenced(const DataItem& other) {
+        referenced.store(other.referenced.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
     void display() const { 
         if (valid) {
             std::cout << data;
@@ -51,16 +65,28 @@ public:
     }
 
     uint32_t getKey() const { return key; }
-    T getData() const { return data; }
+    const T& getData() const { return data; }
     [[nodiscard]] bool isValid() const { return valid; }
+    [[nodiscard]] bool isReferenced() const { return referenced.load(std::memory_order_relaxed); }
 
 
 private:
     // private constructors as only Bucket & std::array can invoke constructor
-    constexpr DataItem() : valid(false), data(T()), key(0) {}
-    constexpr DataItem(const uint32_t key, const T& data) : valid(true), data(data), key(key) {}
+    constexpr DataItem() : valid(false), referenced(false), data(T()), key(0) {}
+    constexpr DataItem(const uint32_t key, const T& data) : valid(true), referenced(false), data(data), key(key) {}
+
+    // Stores a value in this slot, copy or move assigned without any temporary
+    template <typename U>
+    void assign(const uint32_t key, U&& value) {
+        static_assert(std::is_same_v<std::decay_t<U>, T>, "DataItem stores values of type T only");
+        data = std::forward<U>(value);
+        this->key = key;
+        valid = true;
+        referenced.store(false, std::memory_order_relaxed);
+    }
 
     bool valid{ false };    // Initialized as invalid by default
+    mutable std::atomic<bool> referenced{ false }; // Packs into the padding after valid
     T data;                 // Default initialization for data
     uint32_t key{ 0 };      // Default initialization for key
 
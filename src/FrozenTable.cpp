@@ -0,0 +1,92 @@
+#include <algorithm>
+
+#include "FrozenTable.hpp"
+#include "CountedValue.hpp"
+
+/**
+ * @brief Builds the offset directory over a sorted run of entries.
+ *
+ * The depth is the smallest one giving at least one slot per entry, capped at
+ * MAX_KEY_LENGTH. Since slots are indexed by the most significant key bits, the
+ * entries of each slot form one contiguous run of the sorted array.
+ *
+ * @tparam T The type of the stored values.
+ * @param entries The entries of the table, sorted by key.
+ */
+template <typename T>
+FrozenTable<T>::FrozenTable(std::vector<Entry> entries) : entries(std::move(entries)) {
+    this->entries.shrink_to_fit();
+    while (depth < MAX_KEY_LENGTH && ((size_t)1 << depth) < this->entries.size()) {
+        depth++;
+    }
+
+    offsets.assign(((size_t)1 << depth) + 1, 0);
+    for (const Entry& entry : this->entries) {
+        offsets[slotOf(entry.key) + 1]++;
+    }
+    for (size_t i = 1; i < offsets.size(); i++) {
+        offsets[i] += offsets[i - 1];
+    }
+}
+
+template <typename T>
+uint32_t FrozenTable<T>::slotOf(const uint32_t key) const {
+    return depth == 0 ? 0 : (key & MAX_KEY_VALUE) >> (MAX_KEY_LENGTH - depth);
+}
+
+/**
+ * @brief Returns a pointer to the value stored under a key.
+ *
+ * @tparam T The type of the stored values.
+ * @param key The key to look up.
+ * @return A pointer into the table, valid as long as the table, or nullptr if not found.
+ */
+template <typename T>
+const T* FrozenTable<T>::get(const uint32_t key) const {
+    const uint32_t slot = slotOf(key);
+    for (uint32_t i = offsets[slot]; i < offsets[slot + 1]; i++) {
+        if (entries[i].key == key) return &entries[i].data;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Finds the value stored under a key.
+ *
+ * @tparam T The type of the stored values.
+ * @param key The key to look up.
+ * @return std::optional<T> A copy of the value if found, or std::nullopt if not found.
+ */
+template <typename T>
+std::optional<T> FrozenTable<T>::find(const uint32_t key) const {
+    const T* data = get(key);
+    return data ? std::optional<T>(*data) : std::nullopt;
+}
+
+/**
+ * @brief Visits every entry with a key in [lo, hi] in ascending key order.
+ *
+ * @tparam T The type of the stored values.
+ * @param lo The smallest key to visit (inclusive).
+ * @param hi The largest key to visit (inclusive).
+ * @param callback Invoked with the key and data of every matching entry.
+ */
+template <typename T>
+void FrozenTable<T>::scan(const uint32_t lo, const uint32_t hi, const std::function<void(uint32_t, const T&)>& callback) const {
+    auto it = std::lower_bound(entries.begin(), entries.end(), lo,
+                               [](const Entry& entry, uint32_t key) { return entry.key < key; });
+    for (; it != entries.end() && it->key <= hi; ++it) {
+        callback(it->key, it->data);
+    }
+}
+
+/**
+ * @brief Returns the bytes held by the offset directory and the packed entries.
+ */
+template <typename T>
+size_t FrozenTable<T>::getMemoryUsage() const {
+    return sizeof(FrozenTable) + offsets.capacity() * sizeof(uint32_t) + entries.capacity() * sizeof(Entry);
+}
+
+template class FrozenTable<int>;
+template class FrozenTable<CountedValue>;
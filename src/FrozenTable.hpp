@@ -0,0 +1,57 @@
+#pragma once
+#include <optional>
+#include <vector>
+#include <functional>
+
+#include "Common.hpp"
+
+/**
+ * @class FrozenTable
+ * @brief An immutable, pointer-free copy of a table, produced by freeze().
+ *
+ * Entries are packed in ascending key order into one contiguous array, with no invalid
+ * slots and no spare capacity. A dense directory of 2^depth + 1 offsets, indexed by the
+ * most significant key bits like GlobalDirectory::hash, delimits the run of entries of
+ * each slot, so a lookup touches one offset pair and then the entries it points to.
+ * The depth is chosen so that slots hold about one entry each.
+ * The table has no mutable state, so any number of threads may read it without locks.
+ *
+ * @tparam T The type of the stored values.
+ */
+template<typename T>
+class FrozenTable {
+public:
+    struct Entry {
+        uint32_t key;
+        T data;
+    };
+
+    FrozenTable() : FrozenTable(std::vector<Entry>()) {}
+    // entries must be sorted by key
+    explicit FrozenTable(std::vector<Entry> entries);
+
+    // Copies every entry of a table whose scan(lo, hi, callback) visits keys in ascending order,
+    // such as MemoryManager, GlobalDirectory or RadixDirectory
+    template <typename Source>
+    static FrozenTable from(const Source& source) {
+        std::vector<Entry> entries;
+        source.scan(0, MAX_KEY_VALUE, [&entries](uint32_t key, const T& data) { entries.push_back({ key, data }); });
+        return FrozenTable(std::move(entries));
+    }
+
+    [[nodiscard]] std::optional<T> find(const uint32_t key) const;
+    [[nodiscard]] const T* get(const uint32_t key) const;
+    void scan(const uint32_t lo, const uint32_t hi, const std::function<void(uint32_t, const T&)>& callback) const;
+    void forEach(const std::function<void(uint32_t, const T&)>& callback) const { scan(0, MAX_KEY_VALUE, callback); }
+
+    size_t size() const { return entries.size(); }
+    uint8_t getDepth() const { return depth; }
+    size_t getMemoryUsage() const;
+
+private:
+    uint32_t slotOf(const uint32_t key) const;
+
+    uint8_t depth{ 0 };
+    std::vector<uint32_t> offsets;  // offsets[i]..offsets[i + 1] are the entries of slot i
+    std::vector<Entry> entries;     // sorted by key
+};
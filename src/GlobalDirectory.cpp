@@ -2,15 +2,20 @@
 #include <string>
 #include <unordered_map>
 #include <iomanip>
+#include <algorithm>
+#include <thread>
+#include <atomic>
 
 #include "GlobalDirectory.hpp"
 #include "Bucket.hpp"
+#include "CountedValue.hpp"
 
 /**
  * @brief Initializes the GlobalDirectory with an initial file.
  * 
  * This function sets up the GlobalDirectory by creating two initial buckets
- * and setting the global depth to 1. It then rehashes the items from the 
+ * and setting the global depth to 1. In balanced insertion mode it also creates
+ * the initial 2^STASH_MIN_DEPTH stash buckets. It then rehashes the items from the 
  * provided initial file into the newly created buckets.
  * 
  * @tparam T The type of elements stored in the buckets.
@@ -19,19 +24,28 @@
  */
 template <typename T>
 bool GlobalDirectory<T>::initialize(const std::shared_ptr<Bucket<T>>& initialFile) {
-    if (!entry.empty()) return false; // already initialized
+    if (!entry->empty()) return false; // already initialized
 
     globalDepth = 1;
-    entry.resize(2);
-    entry[0] = std::make_shared<Bucket<T>>(globalDepth);
-    entry[1] = std::make_shared<Bucket<T>>(globalDepth);
+    entry = std::make_shared<SlotTable>(2);
+    entry->set(0, Bucket<T>::make(globalDepth, epoch));
+    entry->set(1, Bucket<T>::make(globalDepth, epoch));
+    bucketCount = 2;
+    if (insertionMode == InsertionMode::BALANCED) {
+        stashDepth = STASH_MIN_DEPTH;
+        stash = std::make_shared<SlotTable>((size_t)1 << stashDepth);
+        for (size_t i = 0; i < stash->size(); i++) {
+            stash->set(i, Bucket<T>::make(0, epoch));
+        }
+        bucketCount += stash->size();
+    }
 
     return reHashItems(initialFile);
 }
 
 template <typename T>
 void GlobalDirectory<T>::display() const {
-    if (entry.empty()) return; // Not initialized
+    if (entry->empty()) return; // Not initialized
 
     std::cout << "Global Directory\n";
     std::cout << "Global Depth: " << (uint32_t)globalDepth << "\n";
@@ -40,7 +54,8 @@ void GlobalDirectory<T>::display() const {
     // A, B, C, ..., Z, AA, AB, AC, ..., ZZ, AAA, ...
     std::unordered_map<std::shared_ptr<Bucket<T>>, std::string> bucketNames;
     uint32_t maxWidth = 0;
-    for (const std::shared_ptr<Bucket<T>>& ptr : entry) {
+    for (size_t i = 0; i < entry->size(); ++i) {
+        const std::shared_ptr<Bucket<T>>& ptr = (*entry)[i];
         if (ptr && bucketNames.find(ptr) == bucketNames.end()) {
             std::string name;
             int temp = bucketNames.size();
@@ -54,15 +69,15 @@ void GlobalDirectory<T>::display() const {
         }
     }
 
-    std::cout << "Number of buckets: " << bucketNames.size() << "/" << entry.size() << "\n";
+    std::cout << "Number of buckets: " << bucketNames.size() << "/" << entry->size() << "\n";
     // Print header
     std::cout << std::setw(10) << std::left << "Index"
               << std::setw(maxWidth + 4) << "Bucket"
               << std::setw(12) << "Local Depth"
               << "Entries\n";
 
-    for (size_t i = 0; i < entry.size(); ++i) {
-        const std::shared_ptr<Bucket<T>>& ptr = entry[i];
+    for (size_t i = 0; i < entry->size(); ++i) {
+        const std::shared_ptr<Bucket<T>>& ptr = (*entry)[i];
         if (ptr) {
             std::cout << std::setw(10) << std::left << ("[" + std::to_string(i) + "] ->")
                       << std::setw(maxWidth + 4) << std::left << bucketNames[ptr]
@@ -72,6 +87,14 @@ void GlobalDirectory<T>::display() const {
             std::cout << std::endl;
         }
     }
+    for (size_t i = 0; i < stash->size(); ++i) {
+        std::cout << std::setw(10) << std::left << ("[S" + std::to_string(i) + "] ->")
+                  << std::setw(maxWidth + 4) << std::left << "-"
+                  << std::setw(12) << std::left << "(stash)"
+                  << " ";
+        (*stash)[i]->display();
+        std::cout << std::endl;
+    }
 }
 
 /**
@@ -93,40 +116,109 @@ uint32_t GlobalDirectory<T>::hash(const uint32_t key) const {
 }
 
 /**
- * @brief Writes data to the global directory using the specified key.
+ * @brief Writes a copy of data to the global directory using the specified key.
+ *
+ * The data is copied once and then moved into place, see the rvalue overload.
+ *
+ * @tparam T The type of data to be written.
+ * @param key The key used to determine the position in the directory.
+ * @param data The data to be written to the directory.
+ * @return true if the data was successfully written, false otherwise.
+ */
+template <typename T>
+bool GlobalDirectory<T>::write(const uint32_t key, const T& data) {
+    return write(key, T(data));
+}
+
+/**
+ * @brief Moves data into the global directory using the specified key.
  *
  * This function attempts to write the provided data to the global directory
  * at the position determined by the hash of the key. If the initial write
  * attempt fails, it will retry up to 5 times, extending the directory if necessary.
+ * In balanced insertion mode, the directory only grows once the home bucket, its
+ * neighbour and the stash buckets are all full.
+ * In cache mode, when growing would exceed the memory budget, an item of the
+ * target bucket is evicted with the CLOCK policy instead.
+ * Buckets only move from data once they accept it, so every retry still sees the value.
+ * Keys wider than MAX_KEY_LENGTH bits are rejected, since hash() would drop their high bits.
  *
  * @tparam T The type of data to be written.
  * @param key The key used to determine the position in the directory.
- * @param data The data to be written to the directory.
+ * @param data The data to be moved into the directory.
  * @return true if the data was successfully written, false otherwise.
  */
 template <typename T>
-bool GlobalDirectory<T>::write(const uint32_t key, const T& data) {
-    if (entry.empty()) return false; // Not initialized
+bool GlobalDirectory<T>::write(const uint32_t key, T&& data) {
+    if (entry->empty() || key > MAX_KEY_VALUE) return false; // Not initialized or key out of range
 
     // TODO 5
     uint32_t index = hash(key);
-    if (entry[index]->write(key, data)) return true;
+    if (place(index, key, std::move(data))) return true;
     const int RETRIES = 5;
     for (uint32_t i = 0; i < RETRIES; i++, index = hash(key)) {
+        if (memoryBudget != 0 && getMemoryUsage() + growthCost(index) > memoryBudget) {
+            // Cache mode: make room in the target bucket instead of growing
+            const std::shared_ptr<Bucket<T>>& bucket = writable(index);
+            if (!bucket->evict()) return false;
+            evictions++;
+            return bucket->write(key, std::move(data));
+        }
         if (!extend(index)) continue;
         index = hash(key);
-        if (entry[index]->write(key, data)) return true;
+        if (place(index, key, std::move(data))) return true;
     }
 
     return false;
 }
 
+/**
+ * @brief Replaces the value of an existing key with a copy of data.
+ *
+ * @tparam T The type of data to be written.
+ * @param key The key of the entry to update.
+ * @param data The new value.
+ * @return true if the key was found and updated, false otherwise.
+ */
+template <typename T>
+bool GlobalDirectory<T>::update(const uint32_t key, const T& data) {
+    return update(key, T(data));
+}
+
+/**
+ * @brief Replaces the value of an existing key in place.
+ *
+ * The entry is looked up in the same buckets as get() and overwritten in its slot,
+ * so the directory never changes shape, unlike an erase followed by a write. Only
+ * the bucket holding the key is copied if a snapshot shares it.
+ *
+ * @tparam T The type of data to be written.
+ * @param key The key of the entry to update.
+ * @param data The new value, only moved from if the key was found.
+ * @return true if the key was found and updated, false otherwise.
+ */
+template <typename T>
+bool GlobalDirectory<T>::update(const uint32_t key, T&& data) {
+    if (entry->empty()) return false; // Not initialized
+
+    const uint32_t index = hash(key);
+    if ((*entry)[index]->get(key)) return writable(index)->update(key, std::move(data));
+    if (insertionMode == InsertionMode::SINGLE) return false;
+
+    const uint32_t neighbour = neighbourOf(index);
+    if ((*entry)[neighbour]->get(key)) return writable(neighbour)->update(key, std::move(data));
+    const uint32_t position = stashOf(key);
+    if ((*entry)[index]->getOverflowCount() == 0 || !(*stash)[position]->get(key)) return false;
+    return writableStash(position)->update(key, std::move(data));
+}
+
 /**
  * @brief Erases an entry from the global directory based on the provided key.
  * 
  * This function attempts to remove an entry identified by the given key from the global directory.
  * If the entry is successfully removed, it may also attempt to merge and minimize the directory
- * structure to optimize storage.
+ * structure to optimize storage. In balanced insertion mode the neighbour bucket
+ * is searched as well, and the stash if the home bucket overflowed into it.
  * 
  * @tparam T The type of the elements stored in the global directory.
  * @param key The key of the entry to be erased.
@@ -134,27 +226,41 @@ bool GlobalDirectory<T>::write(const uint32_t key, const T& data) {
  */
 template <typename T>
 bool GlobalDirectory<T>::erase(const uint32_t key) {
-    if (entry.empty()) return false; // Not initialized
+    if (entry->empty()) return false; // Not initialized
 
     // TODO 6
     uint32_t index = hash(key);
-    // get target bucket
-    std::shared_ptr<Bucket<T>> targetBucket = entry[index];
-    if (targetBucket->erase(key)) {
-        while(mergeOn(index) && minimize()) {
-            index = hash(key);
+    // key of the first slot of the bucket holding the entry, to find it again after minimize()
+    uint32_t anchor = key;
+    if (!eraseAt(index, key)) {
+        if (insertionMode == InsertionMode::SINGLE) return false;
+
+        // balanced insertion may have placed the entry in the neighbour or in the stash
+        const uint32_t home = index;
+        index = neighbourOf(home);
+        anchor = index << (MAX_KEY_LENGTH - globalDepth);
+        if (!eraseAt(index, key)) {
+            const uint32_t position = stashOf(key);
+            if ((*entry)[home]->getOverflowCount() == 0 || !(*stash)[position]->get(key)) return false;
+            if (!writableStash(position)->erase(key)) return false;
+            adjustOverflow(home, -1);
+            return true;
         }
-        return true;
     }
 
-    return false;
+    while(mergeOn(index) && minimize()) {
+        index = hash(anchor);
+    }
+    return true;
 }
 
 /**
  * @brief Finds an entry in the GlobalDirectory using the provided key.
  * 
  * This function hashes the given key to determine the index in the directory
- * and then attempts to find the entry associated with that key.
+ * and then attempts to find the entry associated with that key. In balanced
+ * insertion mode a miss in the home bucket also probes its neighbour, and the stash
+ * bucket of the key only if the home bucket overflowed into the stash.
  * 
  * @tparam T The type of the entry stored in the GlobalDirectory.
  * @param key The key used to locate the entry.
@@ -163,8 +269,591 @@ bool GlobalDirectory<T>::erase(const uint32_t key) {
 template <typename T>
 std::optional<T> GlobalDirectory<T>::find(const uint32_t key) const {
     // TODO 4
-    uint32_t index = hash(key);
-    return entry[index]->find(key);
+    std::optional<T> result;
+    visit(key, [&result](const T& data) { result = data; });
+    return result;
+}
+
+/**
+ * @brief Returns a pointer to the data stored under a key, without copying it.
+ *
+ * Probes the same buckets as find, but leaves the CLOCK reference bits untouched,
+ * which also makes it the lookup used by snapshots.
+ *
+ * @tparam T The type of the entries stored in the GlobalDirectory.
+ * @param key The key used to locate the entry.
+ * @return A pointer to the data, valid until the directory is next modified, or nullptr if not found.
+ */
+template <typename T>
+const T* GlobalDirectory<T>::get(const uint32_t key) const {
+    if (entry->empty()) return nullptr; // Not initialized
+
+    const uint32_t index = hash(key);
+    const Bucket<T>& home = *(*entry)[index];
+    const T* data = home.get(key);
+    if (data || insertionMode == InsertionMode::SINGLE) return data;
+
+    data = (*entry)[neighbourOf(index)]->get(key);
+    if (!data && home.getOverflowCount() > 0) {
+        data = (*stash)[stashOf(key)]->get(key);
+    }
+    return data;
+}
+
+/**
+ * @brief Visits every entry with a key in [lo, hi] in ascending key order.
+ *
+ * Since hash() keeps the most significant key bits, directory slots are already
+ * ordered by key at bucket granularity. Only the buckets covering [lo, hi] are visited,
+ * stepping from each one to the first slot of the next by its slot span, so a single
+ * slot is read per bucket, and each bucket sorts its own matching items. Keys fit in MAX_KEY_LENGTH bits, as write() rejects wider ones.
+ * In balanced insertion mode, the neighbour of the last bucket and the stash
+ * buckets covering [lo, hi] are scanned too and all matches are sorted together.
+ *
+ * @tparam T The type of the entries stored in the GlobalDirectory.
+ * @param lo The smallest key to visit (inclusive).
+ * @param hi The largest key to visit (inclusive).
+ * @param callback Invoked with the key and data of every matching entry.
+ */
+template <typename T>
+void GlobalDirectory<T>::scan(const uint32_t lo, const uint32_t hi, const std::function<void(uint32_t, const T&)>& callback) const {
+    if (entry->empty() || lo > hi || lo > MAX_KEY_VALUE) return;
+
+    const uint32_t first = hash(lo);
+    const uint32_t last = hash(std::min(hi, MAX_KEY_VALUE));
+    if (insertionMode == InsertionMode::SINGLE) {
+        for (uint32_t index = first; index <= last; index += slotsOf(index) - (index & (slotsOf(index) - 1))) {
+            (*entry)[index]->scan(lo, hi, callback);
+        }
+        return;
+    }
+
+    // Entries may have been displaced into the neighbour of the last bucket or into
+    // the stash, so matches are gathered from all candidates and sorted once
+    std::vector<std::pair<uint32_t, const T*>> matches;
+    auto collect = [&matches](uint32_t key, const T& data) { matches.emplace_back(key, &data); };
+    for (uint32_t index = first; index <= last; index += slotsOf(index) - (index & (slotsOf(index) - 1))) {
+        (*entry)[index]->scan(lo, hi, collect);
+    }
+    const uint32_t neighbour = neighbourOf(last);
+    if (neighbour < first || neighbour > last) {
+        (*entry)[neighbour]->scan(lo, hi, collect);
+    }
+    for (uint32_t position = stashOf(lo); position <= stashOf(std::min(hi, MAX_KEY_VALUE)); position++) {
+        (*stash)[position]->scan(lo, hi, collect);
+    }
+
+    std::sort(matches.begin(), matches.end(),
+              [](const std::pair<uint32_t, const T*>& a, const std::pair<uint32_t, const T*>& b) { return a.first < b.first; });
+    for (const auto& match : matches) {
+        callback(match.first, *match.second);
+    }
+}
+
+/**
+ * @brief Takes a point-in-time snapshot of the directory in constant time.
+ *
+ * The snapshot is a read-only directory sharing the current directory and stash
+ * tables and the buckets, which only costs a few reference counts whatever the size
+ * of the tables. Bumping the epoch marks every existing bucket as shared: before the
+ * live directory modifies one, writable() or writableStash() replaces it with a copy.
+ * Slots are reassigned through SlotTable::set(), which copies the one segment holding
+ * them, after ownEntries() or ownStash() copied the list of segments. A write after a
+ * snapshot therefore copies the buckets and segments on its path, never a whole table. Doubling or halving the directory still rebuilds the
+ * table, as it does without snapshots. The snapshot must be taken by the writer
+ * (or under its lock), but may then be read from any thread while writes continue.
+ *
+ * @tparam T The type of the entries stored in the GlobalDirectory.
+ * @return Snapshot A handle that keeps the shared state alive while it exists.
+ */
+template <typename T>
+typename GlobalDirectory<T>::Snapshot GlobalDirectory<T>::snapshot() {
+    std::shared_ptr<GlobalDirectory> view(new GlobalDirectory());
+    view->globalDepth = globalDepth;
+    view->entry = entry;
+    view->insertionMode = insertionMode;
+    view->stash = stash;
+    view->stashDepth = stashDepth;
+    view->bucketCount = bucketCount;
+    view->snapshotRefs = snapshotRefs;
+    epoch++;
+    return Snapshot(std::move(view));
+}
+
+/**
+ * @brief Tells whether a bucket may still be read by a live snapshot.
+ *
+ * @tparam T The type of the entries stored in the GlobalDirectory.
+ * @param bucket A bucket of the live directory.
+ * @return true if the bucket predates the last snapshot and a snapshot is still alive.
+ */
+template <typename T>
+bool GlobalDirectory<T>::isShared(const Bucket<T>& bucket) const {
+    if (bucket.getEpoch() == epoch) return false; // created after the last snapshot
+    if (snapshotRefs.use_count() > 1) return true;
+    // The last snapshot may have been released by a reader, order its reads before our writes
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return false;
+}
+
+/**
+ * @brief Copies the directory table if a snapshot still shares it.
+ *
+ * Must be called before any slot of the table is reassigned in place. Only the list of
+ * segments is copied, 2^(globalDepth - DIRECTORY_SEGMENT_BITS) pointers; the segments
+ * stay shared until SlotTable::set() copies the ones whose slots actually change.
+ *
+ * @tparam T The type of the entries stored in the GlobalDirectory.
+ */
+template <typename T>
+void GlobalDirectory<T>::ownEntries() {
+    if (entry.use_count() > 1) {
+        entry = std::make_shared<SlotTable>(*entry);
+        return;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+}
+
+/**
+ * @brief Copies the stash table if a snapshot still shares it.
+ *
+ * Must be called before any stash position is reassigned in place. As with
+ * ownEntries(), only the list of segments is copied.
+ *
+ * @tparam T The type of the entries stored in the GlobalDirectory.
+ */
+template <typename T>
+void GlobalDirectory<T>::ownStash() {
+    if (stash.use_count() > 1) {
+        stash = std::make_shared<SlotTable>(*stash);
+        return;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+}
+
+/**
+ * @brief Returns the bucket at the given slot, ready to be modified.
+ *
+ * A bucket shared with a snapshot is first copied, and every slot pointing
+ * to it is redirected to the copy.
+ *
+ * @tparam T The type of the entries stored in the GlobalDirectory.
+ * @param index Any directory slot pointing to the bucket.
+ * @return The bucket now owned by the live directory.
+ */
+template <typename T>
+const std::shared_ptr<Bucket<T>>& GlobalDirectory<T>::writable(const uint32_t index) {
+    if (!isShared(*(*entry)[index])) return (*entry)[index];
+
+    ownEntries();
+    const std::shared_ptr<Bucket<T>> copy = (*entry)[index]->clone(epoch);
+    const uint32_t slots = slotsOf(index);
+    const uint32_t first = index & ~(slots - 1);
+    for (uint32_t i = first; i < first + slots; i++) {
+        entry->set(i, copy);
+    }
+    return (*entry)[index];
+}
+
+/**
+ * @brief Returns the stash bucket at the given position, copied first if a snapshot shares it.
+ *
+ * @tparam T The type of the entries stored in the GlobalDirectory.
+ * @param position The position of the bucket in the stash.
+ * @return The stash bucket now owned by the live directory.
+ */
+template <typename T>
+const std::shared_ptr<Bucket<T>>& GlobalDirectory<T>::writableStash(const size_t position) {
+    if (isShared(*(*stash)[position])) {
+        ownStash();
+        stash->set(position, (*stash)[position]->clone(epoch));
+    }
+    return (*stash)[position];
+}
+
+/**
+ * @brief Erases a key from the bucket at the given slot, copying the bucket only if the key is there.
+ *
+ * @tparam T The type of the entries stored in the GlobalDirectory.
+ * @param index Any directory slot pointing to the bucket.
+ * @param key The key to erase.
+ * @return true if the key was found and erased, false otherwise.
+ */
+template <typename T>
+bool GlobalDirectory<T>::eraseAt(const uint32_t index, const uint32_t key) {
+    if (!(*entry)[index]->get(key)) return false;
+    return writable(index)->erase(key);
+}
+
+/**
+ * @brief Returns the number of directory slots owned by the bucket at the given index.
+ *
+ * @tparam T The type of the entries stored in the GlobalDirectory.
+ * @param index Any directory slot pointing to the bucket.
+ * @return 2^(globalDepth - localDepth) of the bucket.
+ */
+template <typename T>
+uint32_t GlobalDirectory<T>::slotsOf(const size_t index) const {
+    return 1 << (globalDepth - (*entry)[index]->getLocalDepth());
+}
+
+/**
+ * @brief Resolves the number of workers used by forEachBucket.
+ *
+ * A request of 0 threads means one worker per hardware thread. The result is
+ * never larger than the number of directory slots and never smaller than one.
+ *
+ * @tparam T The type of the entries stored in the GlobalDirectory.
+ * @param threads The requested number of workers.
+ * @return The number of workers that will be used.
+ */
+template <typename T>
+size_t GlobalDirectory<T>::workerCount(const size_t threads) const {
+    return resolveWorkerCount(threads, entry->size());
+}
+
+/**
+ * @brief Visits every distinct bucket exactly once using a pool of worker threads.
+ *
+ * The directory is split into contiguous slot ranges, one per worker. A bucket is
+ * visited by the worker whose range contains its first slot; since a bucket of local
+ * depth d owns 2^(globalDepth - d) aligned slots, a worker that starts in the middle
+ * of a bucket skips to the end of it and every step afterwards jumps a whole bucket.
+ * The stash buckets of balanced insertion mode are visited by the calling thread.
+ * The callback receives the worker index and must be safe to call concurrently.
+ * The directory must not be modified while the visit is running.
+ *
+ * @tparam T The type of the entries stored in the GlobalDirectory.
+ * @param callback Invoked with the worker index and each distinct bucket.
+ * @param threads The number of workers to use, 0 for one per hardware thread.
+ * @return The number of workers that were used.
+ */
+template <typename T>
+size_t GlobalDirectory<T>::forEachBucket(const std::function<void(size_t, const Bucket<T>&)>& callback, size_t threads) const {
+    if (entry->empty()) return 0; // Not initialized
+
+    const size_t workers = workerCount(threads);
+    auto visitRange = [&](size_t worker) {
+        const size_t first = entry->size() * worker / workers;
+        const size_t last = entry->size() * (worker + 1) / workers;
+        for (size_t index = first; index < last;) {
+            const uint32_t slots = slotsOf(index);
+            const size_t start = index & ~static_cast<size_t>(slots - 1);
+            if (start == index) {
+                callback(worker, *(*entry)[index]);
+            }
+            index = start + slots;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (size_t worker = 1; worker < workers; worker++) {
+        pool.emplace_back(visitRange, worker);
+    }
+    visitRange(0);
+    for (size_t position = 0; position < stash->size(); position++) {
+        callback(0, *(*stash)[position]);
+    }
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+    return workers;
+}
+
+/**
+ * @brief Visits every entry of the directory exactly once in parallel.
+ *
+ * Buckets are distributed across workers as in forEachBucket, so the callback
+ * must be safe to call concurrently. No ordering between entries is guaranteed.
+ *
+ * @tparam T The type of the entries stored in the GlobalDirectory.
+ * @param callback Invoked with the key and data of every entry.
+ * @param threads The number of workers to use, 0 for one per hardware thread.
+ */
+template <typename T>
+void GlobalDirectory<T>::forEach(const std::function<void(uint32_t, const T&)>& callback, size_t threads) const {
+    forEachBucket([&callback](size_t, const Bucket<T>& bucket) {
+        bucket.forEach(callback);
+    }, threads);
+}
+
+/**
+ * @brief Estimates the memory held by the directory and its buckets.
+ *
+ * Counts every distinct bucket with its shared_ptr control block, plus the
+ * directory array itself.
+ *
+ * @tparam T The type of the entries stored in the GlobalDirectory.
+ * @return The estimated number of bytes in use.
+ */
+template <typename T>
+size_t GlobalDirectory<T>::getMemoryUsage() const {
+    return bucketCount * bucketBytes() + entry->memoryBytes();
+}
+
+template <typename T>
+size_t GlobalDirectory<T>::bucketBytes() {
+    return sizeof(Bucket<T>) + 2 * sizeof(long); // shared_ptr control block counters
+}
+
+/**
+ * @brief Estimates the extra memory needed to make room in the bucket at the given hash value.
+ *
+ * Splitting a bucket shared by several slots adds one bucket. Extending a bucket
+ * at global depth also doubles the directory array.
+ *
+ * @tparam T The type of the entries stored in the GlobalDirectory.
+ * @param hashValue The hash value of the full bucket.
+ * @return The estimated number of extra bytes.
+ */
+template <typename T>
+size_t GlobalDirectory<T>::growthCost(const uint32_t hashValue) const {
+    if ((*entry)[hashValue]->getLocalDepth() < globalDepth) return bucketBytes();
+    return bucketBytes() + entry->size() * sizeof(std::shared_ptr<Bucket<T>>);
+}
+
+/**
+ * @brief Returns the index of the first slot of the bucket following the one at the given index.
+ *
+ * This is the second candidate bucket of balanced insertion mode. The last bucket of
+ * the directory wraps around to the first one.
+ *
+ * @tparam T The type of the entries stored in the GlobalDirectory.
+ * @param index Any directory slot pointing to the home bucket.
+ * @return The first slot of the neighbouring bucket.
+ */
+template <typename T>
+uint32_t GlobalDirectory<T>::neighbourOf(const uint32_t index) const {
+    const uint32_t slots = slotsOf(index);
+    return ((index & ~(slots - 1)) + slots) % entry->size();
+}
+
+/**
+ * @brief Returns the position of the stash bucket covering a key.
+ *
+ * Like hash(), the stash is indexed by the most significant key bits, so each stash
+ * bucket serves a contiguous range of directory slots and a lookup probes at most one.
+ *
+ * @tparam T The type of the entries stored in the GlobalDirectory.
+ * @param key The key of the entry.
+ * @return The position of the stash bucket in the stash.
+ */
+template <typename T>
+uint32_t GlobalDirectory<T>::stashOf(const uint32_t key) const {
+    return (key & MAX_KEY_VALUE) >> (MAX_KEY_LENGTH - stashDepth);
+}
+
+/**
+ * @brief Adds delta to the overflow count of the bucket at the given slot.
+ *
+ * @tparam T The type of the entries stored in the GlobalDirectory.
+ * @param index Any directory slot pointing to the home bucket of the stashed entry.
+ * @param delta 1 when an entry homed there enters the stash, -1 when it leaves it.
+ */
+template <typename T>
+void GlobalDirectory<T>::adjustOverflow(const uint32_t index, const int delta) {
+    const std::shared_ptr<Bucket<T>>& home = writable(index);
+    home->setOverflowCount(home->getOverflowCount() + delta);
+}
+
+/**
+ * @brief Recomputes the overflow count of a bucket that just replaced others in the directory.
+ *
+ * Counts the stash entries whose key falls in the slots of the bucket. Only the stash
+ * buckets covering those slots are inspected. The bucket must have been created since
+ * the last snapshot, so it is updated in place.
+ *
+ * @tparam T The type of the entries stored in the GlobalDirectory.
+ * @param index Any directory slot pointing to the new bucket.
+ */
+template <typename T>
+void GlobalDirectory<T>::recountOverflow(const uint32_t index) {
+    if (insertionMode == InsertionMode::SINGLE) return;
+
+    const uint32_t slots = slotsOf(index);
+    const uint32_t lo = (index & ~(slots - 1)) << (MAX_KEY_LENGTH - globalDepth);
+    const uint32_t hi = lo + (slots << (MAX_KEY_LENGTH - globalDepth)) - 1;
+    uint32_t count = 0;
+    for (uint32_t position = stashOf(lo); position <= stashOf(hi); position++) {
+        (*stash)[position]->forEach([&](uint32_t key, const T&) {
+            count += (key & MAX_KEY_VALUE) >= lo && (key & MAX_KEY_VALUE) <= hi;
+        });
+    }
+    (*entry)[index]->setOverflowCount(count);
+}
+
+/**
+ * @brief Doubles the stash, splitting every stash bucket on the next key bit.
+ *
+ * Called as the directory grows, so that the stash keeps one bucket per
+ * 2^STASH_SPAN_BITS directory slots. Each new bucket receives a subset of one old
+ * bucket, so every entry fits. Entries are moved out of the old buckets, unless a
+ * snapshot may still read them, in which case they are copied. Overflow counts are
+ * unchanged since entries keep their home bucket. The stash never shrinks.
+ *
+ * @tparam T The type of the entries stored in the GlobalDirectory.
+ */
+template <typename T>
+void GlobalDirectory<T>::growStash() {
+    const std::shared_ptr<SlotTable> old = stash;
+    stash = std::make_shared<SlotTable>(old->size() * 2);
+    for (size_t position = 0; position < stash->size(); position++) {
+        stash->set(position, Bucket<T>::make(0, epoch));
+    }
+    stashDepth++;
+
+    for (size_t position = 0; position < old->size(); position++) {
+        const std::shared_ptr<Bucket<T>>& bucket = (*old)[position];
+        const bool movable = !isShared(*bucket);
+        const auto& items = bucket->getItems();
+        for (size_t slot = 0; slot < items.size(); slot++) {
+            if (!items[slot].isValid()) continue;
+            const uint32_t key = items[slot].getKey();
+            (*stash)[stashOf(key)]->write(key, movable ? bucket->take(slot) : T(items[slot].getData()));
+        }
+    }
+    bucketCount += old->size();
+}
+
+/**
+ * @brief Selects how write places entries, only allowed before the directory is initialized.
+ *
+ * @tparam T The type of the entries stored in the GlobalDirectory.
+ * @param mode SINGLE to split as soon as the home bucket is full, BALANCED to also
+ *             use the neighbour bucket and the stash first.
+ * @return true if the mode was set, false if the directory is already initialized.
+ */
+template <typename T>
+bool GlobalDirectory<T>::setInsertionMode(const InsertionMode mode) {
+    if (!entry->empty()) return false; // already initialized
+
+    insertionMode = mode;
+    return true;
+}
+
+/**
+ * @brief Computes the fraction of bucket slots, stash included, holding a valid entry.
+ *
+ * Walks the distinct buckets, stash included, on the calling thread, a cheap pass over the directory.
+ *
+ * @tparam T The type of the entries stored in the GlobalDirectory.
+ * @return The load factor, 0 if the directory is not initialized.
+ */
+template <typename T>
+double GlobalDirectory<T>::getLoadFactor() const {
+    if (bucketCount == 0) return 0.0;
+
+    size_t entries = 0;
+    for (const Bucket<T>& bucket : *this) {
+        entries += bucket.getEntryCount();
+    }
+    return (double)entries / ((double)bucketCount * BUCKET_CAPACITY);
+}
+
+/**
+ * @brief Places an entry in one of its candidate buckets without growing the directory.
+ *
+ * In SINGLE mode the only candidate is the home bucket. In BALANCED mode, as in Dash,
+ * the home bucket and its neighbour are both candidates and the less loaded one is
+ * tried first (the home bucket on ties), then the stash bucket covering the key. An
+ * entry placed in the stash is counted on its home bucket, so that lookups only probe
+ * the stash for home buckets that actually overflowed.
+ *
+ * @tparam T The type of data to be written.
+ * @param index The home slot of the key.
+ * @param key The key of the entry.
+ * @param data The data of the entry, only moved from if the entry was placed.
+ * @return true if the entry was placed, false if every candidate is full.
+ */
+template <typename T>
+bool GlobalDirectory<T>::place(const uint32_t index, const uint32_t key, T&& data) {
+    // Full buckets are skipped up front, so that a failed write never copies a shared bucket
+    auto tryWrite = [&](const uint32_t slot) {
+        return (*entry)[slot]->getEntryCount() < BUCKET_CAPACITY && writable(slot)->write(key, std::move(data));
+    };
+    if (insertionMode == InsertionMode::SINGLE) return tryWrite(index);
+
+    const uint32_t neighbour = neighbourOf(index);
+    const bool neighbourFirst = (*entry)[neighbour]->getEntryCount() < (*entry)[index]->getEntryCount();
+    if (tryWrite(neighbourFirst ? neighbour : index)) return true;
+    if (tryWrite(neighbourFirst ? index : neighbour)) return true;
+
+    const uint32_t position = stashOf(key);
+    if ((*stash)[position]->getEntryCount() == BUCKET_CAPACITY || !writableStash(position)->write(key, std::move(data))) return false;
+    adjustOverflow(index, 1);
+    return true;
+}
+
+/**
+ * @brief Re-places entries that a structural change left outside their candidate buckets.
+ *
+ * After the bucket before `neighbour` is split, entries it had displaced into
+ * `neighbour` may now belong to a half whose neighbour is no longer `neighbour`.
+ * Those entries are taken out first and only then written again, so that splits
+ * triggered by the rewrites never see stale copies. If `neighbour` itself was
+ * replaced in the meantime, its entries were already rehashed and it is skipped.
+ * Entries parked in the stash buckets covering the split range, or the slot just
+ * before it, are also moved back into a candidate bucket that has room, keeping the
+ * stash free for the next overflow.
+ *
+ * @tparam T The type of the entries stored in the GlobalDirectory.
+ * @param neighbour The bucket that followed the split bucket.
+ * @param neighbourKey A key covered by the neighbour, used to check it is still in the directory.
+ * @param lo The smallest key covered by the split bucket.
+ * @param hi The largest key covered by the split bucket.
+ * @return true if every relocated entry was written again, false otherwise.
+ */
+template <typename T>
+bool GlobalDirectory<T>::relocateDisplaced(const std::shared_ptr<Bucket<T>>& neighbour, const uint32_t neighbourKey,
+                                           const uint32_t lo, const uint32_t hi) {
+    if (insertionMode == InsertionMode::SINGLE) return true;
+
+    std::vector<std::pair<uint32_t, T>> displaced;
+    if ((*entry)[hash(neighbourKey)] == neighbour) {
+        // Slots are chosen before anything is taken, since copying a shared neighbour redirects its slots
+        std::vector<size_t> slots;
+        const auto& items = neighbour->getItems();
+        for (size_t slot = 0; slot < items.size(); slot++) {
+            if (!items[slot].isValid()) continue;
+            const uint32_t index = hash(items[slot].getKey());
+            if ((*entry)[index] != neighbour && (*entry)[neighbourOf(index)] != neighbour) {
+                slots.push_back(slot);
+            }
+        }
+        for (size_t slot : slots) {
+            const std::shared_ptr<Bucket<T>>& bucket = writable(hash(neighbourKey));
+            displaced.emplace_back(items[slot].getKey(), bucket->take(slot));
+        }
+    }
+
+    // The split halves, and the neighbour of the bucket before them, are the candidates that gained room
+    std::vector<uint32_t> positions;
+    for (uint32_t position = stashOf(lo); position <= stashOf(hi); position++) {
+        positions.push_back(position);
+    }
+    const uint32_t before = stashOf((lo - 1) & MAX_KEY_VALUE);
+    if (before < stashOf(lo) || before > stashOf(hi)) positions.push_back(before);
+
+    for (uint32_t position : positions) {
+        const std::shared_ptr<Bucket<T>> parked = (*stash)[position];
+        const auto& items = parked->getItems();
+        for (size_t slot = 0; slot < items.size(); slot++) {
+            if (!items[slot].isValid()) continue;
+            const uint32_t index = hash(items[slot].getKey());
+            if ((*entry)[index]->getEntryCount() < BUCKET_CAPACITY ||
+                (*entry)[neighbourOf(index)]->getEntryCount() < BUCKET_CAPACITY) {
+                const uint32_t key = items[slot].getKey();
+                displaced.emplace_back(key, writableStash(position)->take(slot));
+                adjustOverflow(index, -1);
+            }
+        }
+    }
+
+    for (auto& item : displaced) {
+        if (!write(item.first, std::move(item.second))) return false;
+    }
+    return true;
 }
 
 /**
@@ -173,6 +862,8 @@ std::optional<T> GlobalDirectory<T>::find(const uint32_t key) const {
  * This function iterates through all items in the provided old bucket and rehashes
  * them into the global directory. Only valid items are rehashed. If any item fails
  * to be written to the new location, the function returns false.
+ * The old bucket is no longer in the directory, so its values are moved out of it,
+ * unless a snapshot may still read it, in which case they are copied.
  *
  * @tparam T The type of the items stored in the bucket.
  * @param oldBucket A shared pointer to the bucket containing the items to be rehashed.
@@ -180,9 +871,12 @@ std::optional<T> GlobalDirectory<T>::find(const uint32_t key) const {
  */
 template<typename T>
 bool GlobalDirectory<T>::reHashItems(const std::shared_ptr<Bucket<T>>& oldBucket) {
-    for (const auto& item : oldBucket->getItems()) {
-        if (item.isValid()) {
-            if(!write(item.getKey(), item.getData())) return false;
+    const bool movable = !isShared(*oldBucket);
+    const auto& items = oldBucket->getItems();
+    for (size_t slot = 0; slot < items.size(); slot++) {
+        if (items[slot].isValid()) {
+            const uint32_t key = items[slot].getKey();
+            if(!write(key, movable ? oldBucket->take(slot) : T(items[slot].getData()))) return false;
         }
     }
     return true;
@@ -207,27 +901,39 @@ bool GlobalDirectory<T>::reHashItems(const std::shared_ptr<Bucket<T>>& oldBucket
  * 3. Creates two new buckets (newBucket1 and newBucket2) with an incremented local depth.
  * 4. Updates the directory entries to point to the new buckets.
  * 5. Calls the reHashItems function to redistribute the entries from the old bucket to the new buckets.
+ * 6. In balanced insertion mode, relocates entries the old bucket had displaced into its neighbour.
  */
 template<typename T>
 bool GlobalDirectory<T>::splitOn(const uint32_t hashValue) {
     // TODO 7
     uint32_t index = hashValue;
-    while(index > 0 && entry[index] == entry[index - 1]) {
+    while(index > 0 && (*entry)[index] == (*entry)[index - 1]) {
         index--;
     }
-    uint32_t oldNumPtrs = 1 << (globalDepth - entry[index]->getLocalDepth());
+    uint32_t oldNumPtrs = 1 << (globalDepth - (*entry)[index]->getLocalDepth());
     uint32_t newNumPtrs = oldNumPtrs / 2;
+    // bucket that may hold entries displaced from the old bucket
+    const uint32_t neighbourIndex = (index + oldNumPtrs) % entry->size();
+    std::shared_ptr<Bucket<T>> neighbour = (*entry)[neighbourIndex];
+    const uint32_t neighbourKey = neighbourIndex << (MAX_KEY_LENGTH - globalDepth);
+    // keys covered by the old bucket
+    const uint32_t lo = index << (MAX_KEY_LENGTH - globalDepth);
+    const uint32_t hi = lo + (oldNumPtrs << (MAX_KEY_LENGTH - globalDepth)) - 1;
     // old bucket
-    std::shared_ptr<Bucket<T>> oldBucket = entry[index];
+    std::shared_ptr<Bucket<T>> oldBucket = (*entry)[index];
     // new bucket
-    std::shared_ptr<Bucket<T>> newBucket1 = std::make_shared<Bucket<T>>(oldBucket->getLocalDepth() + 1);
-    std::shared_ptr<Bucket<T>> newBucket2 = std::make_shared<Bucket<T>>(oldBucket->getLocalDepth() + 1);
+    std::shared_ptr<Bucket<T>> newBucket1 = Bucket<T>::make(oldBucket->getLocalDepth() + 1, epoch);
+    std::shared_ptr<Bucket<T>> newBucket2 = Bucket<T>::make(oldBucket->getLocalDepth() + 1, epoch);
+    ownEntries();
     for(size_t i = 0; i < newNumPtrs; i++) {
-        entry[index + i] = newBucket1;
-        entry[index + i + newNumPtrs] = newBucket2;
+        entry->set(index + i, newBucket1);
+        entry->set(index + i + newNumPtrs, newBucket2);
     }
+    bucketCount++;
+    recountOverflow(index);
+    recountOverflow(index + newNumPtrs);
 
-    return reHashItems(oldBucket);
+    return reHashItems(oldBucket) && relocateDisplaced(neighbour, neighbourKey, lo, hi);
 }
 
 /**
@@ -244,7 +950,7 @@ bool GlobalDirectory<T>::splitOn(const uint32_t hashValue) {
  */
 template <typename T>
 bool GlobalDirectory<T>::extend(const uint32_t hashValue) {
-    std::shared_ptr<Bucket<T>> oldBucket = entry[hashValue];
+    std::shared_ptr<Bucket<T>> oldBucket = (*entry)[hashValue];
     if (oldBucket->getLocalDepth() < globalDepth) {
         return splitOn(hashValue);
     }
@@ -253,24 +959,37 @@ bool GlobalDirectory<T>::extend(const uint32_t hashValue) {
     if (globalDepth >= MAX_KEY_LENGTH) return false;
 
     uint8_t oldGlobalDepth = globalDepth;
-    size_t oldLength = entry.size();
-    std::vector<std::shared_ptr<Bucket<T>>> newEntry(2 * oldLength);
+    size_t oldLength = entry->size();
+    // bucket that may hold entries displaced from the old bucket
+    const uint32_t neighbourIndex = (hashValue + 1) % oldLength;
+    std::shared_ptr<Bucket<T>> neighbour = (*entry)[neighbourIndex];
+    const uint32_t neighbourKey = neighbourIndex << (MAX_KEY_LENGTH - oldGlobalDepth);
+    // keys covered by the old bucket
+    const uint32_t lo = hashValue << (MAX_KEY_LENGTH - oldGlobalDepth);
+    const uint32_t hi = lo + (1u << (MAX_KEY_LENGTH - oldGlobalDepth)) - 1;
+    SlotTable newEntry(2 * oldLength);
     // TODO 9
 
     for (size_t oldIdx = 0, newIdx = 0; oldIdx < oldLength;) {
-        int oldNumPtrs = 1 << (oldGlobalDepth - entry[oldIdx]->getLocalDepth());
+        int oldNumPtrs = 1 << (oldGlobalDepth - (*entry)[oldIdx]->getLocalDepth());
         for (size_t i = 0; i< oldNumPtrs * 2; i++) {
-            newEntry[newIdx++] = entry[oldIdx];
+            newEntry.set(newIdx++, (*entry)[oldIdx]);
         }
         oldIdx += oldNumPtrs;
     }
-    newEntry[hashValue * 2] = std::make_shared<Bucket<T>>(oldBucket->getLocalDepth() + 1);
-    newEntry[hashValue * 2 + 1] = std::make_shared<Bucket<T>>(oldBucket->getLocalDepth() + 1);
+    newEntry.set(hashValue * 2, Bucket<T>::make(oldBucket->getLocalDepth() + 1, epoch));
+    newEntry.set(hashValue * 2 + 1, Bucket<T>::make(oldBucket->getLocalDepth() + 1, epoch));
     globalDepth = oldGlobalDepth + 1;
+    bucketCount++;
 
     // END TODO
-    entry = std::move(newEntry);
-    return reHashItems(oldBucket);
+    entry = std::make_shared<SlotTable>(std::move(newEntry));
+    if (insertionMode == InsertionMode::BALANCED && globalDepth > stashDepth + STASH_SPAN_BITS) {
+        growStash();
+    }
+    recountOverflow(hashValue * 2);
+    recountOverflow(hashValue * 2 + 1);
+    return reHashItems(oldBucket) && relocateDisplaced(neighbour, neighbourKey, lo, hi);
 }
 
 /**
@@ -292,22 +1011,25 @@ bool GlobalDirectory<T>::mergeOn(const uint32_t hashValue) {
     // TODO 8
 
     int deleteIndex = hashValue;
-    while (deleteIndex > 0 && entry[deleteIndex] == entry[deleteIndex - 1]) {
+    while (deleteIndex > 0 && (*entry)[deleteIndex] == (*entry)[deleteIndex - 1]) {
         deleteIndex--;
     }
-    auto deleteBucket = entry[deleteIndex];
+    auto deleteBucket = (*entry)[deleteIndex];
     uint32_t numPtrs = 1 << (globalDepth - deleteBucket->getLocalDepth());
     uint32_t buddyIndex = deleteIndex ^ numPtrs;
-    auto buddyBucket = entry[buddyIndex];
+    auto buddyBucket = (*entry)[buddyIndex];
     if (deleteBucket->getLocalDepth() != buddyBucket->getLocalDepth() ||
     deleteBucket->getEntryCount() + buddyBucket->getEntryCount() > BUCKET_CAPACITY) return false;
     
     // merge
     uint32_t minIndex = deleteIndex < buddyIndex ? deleteIndex : buddyIndex;
-    std::shared_ptr<Bucket<T>> mergedBucket = std::make_shared<Bucket<T>>(deleteBucket->getLocalDepth() - 1);
+    std::shared_ptr<Bucket<T>> mergedBucket = Bucket<T>::make(deleteBucket->getLocalDepth() - 1, epoch);
+    ownEntries();
     for (size_t i = minIndex; i < minIndex + numPtrs * 2; i++) {
-        entry[i] = mergedBucket;
+        entry->set(i, mergedBucket);
     }
+    bucketCount--;
+    recountOverflow(minIndex);
 
     return reHashItems(deleteBucket) && reHashItems(buddyBucket);
 }
@@ -328,22 +1050,23 @@ template <typename T>
 bool GlobalDirectory<T>::minimize() {
     if (globalDepth == 1) return false;
 
-    for(size_t i = 0; i < entry.size(); i++) {
-        if(entry[i]->getLocalDepth() == globalDepth) {
+    for(size_t i = 0; i < entry->size(); i++) {
+        if((*entry)[i]->getLocalDepth() == globalDepth) {
             return false;
         }
     }
 
     globalDepth--;
 
-    std::vector<std::shared_ptr<Bucket<T>>> newEntry(entry.size() / 2);
+    SlotTable newEntry(entry->size() / 2);
     for(size_t i = 0; i < newEntry.size(); i++) {
-        newEntry[i] = entry[i * 2];
+        newEntry.set(i, (*entry)[i * 2]);
     }
 
-    entry = std::move(newEntry);
+    entry = std::make_shared<SlotTable>(std::move(newEntry));
 
     return true;
 }
 
 template class GlobalDirectory<int>;
+template class GlobalDirectory<CountedValue>;
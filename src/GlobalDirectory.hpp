@@ -2,15 +2,82 @@
 #include <optional>
 #include <vector>
 #include <memory>
+#include <functional>
+#include <algorithm>
+#include <atomic>
 
 #include "Common.hpp"
+#include "ParallelReduce.hpp"
+#include "HugePageAllocator.hpp"
+#include "FrozenTable.hpp"
 
 template<typename T>
 class Bucket;
 
+enum class InsertionMode {
+    SINGLE,     // an entry lives in its home bucket, which splits as soon as it is full
+    BALANCED    // Dash-style: home or neighbour bucket, then its stash bucket, split only when all are full
+};
+
 template<typename T>
 class GlobalDirectory {
 public:
+    // Iterates over every distinct bucket: the directory buckets by slot, then the stash buckets.
+    // A bucket of local depth d owns 2^(globalDepth - d) consecutive, aligned slots,
+    // so stepping by that span always lands on the first slot of the next bucket.
+    // Balanced insertion may displace entries into a neighbour or the stash, so the
+    // entries are not visited in key order, use scan() for that.
+    class BucketIterator {
+    public:
+        BucketIterator(const GlobalDirectory& directory, size_t index) : directory(directory), index(index) {}
+
+        const Bucket<T>& operator*() const {
+            const size_t slots = directory.entry->size();
+            return index < slots ? *(*directory.entry)[index] : *(*directory.stash)[index - slots];
+        }
+        BucketIterator& operator++() {
+            index += index < directory.entry->size() ? directory.slotsOf(index) : 1;
+            return *this;
+        }
+        bool operator!=(const BucketIterator& other) const { return index != other.index; }
+
+    private:
+        const GlobalDirectory& directory;
+        size_t index;
+    };
+
+    // Consistent, read-only view of the directory at the time snapshot() was called.
+    // Shares the directory segments, the stash and the buckets with the live directory, which
+    // copies whatever it modifies afterwards, so readers never block writers nor see their changes.
+    // Handles are cheap to copy and may be read from any thread.
+    class Snapshot {
+    public:
+        [[nodiscard]] std::optional<T> find(const uint32_t key) const {
+            const T* data = directory->get(key);
+            return data ? std::optional<T>(*data) : std::nullopt;
+        }
+        [[nodiscard]] const T* get(const uint32_t key) const { return directory->get(key); }
+        void scan(const uint32_t lo, const uint32_t hi, const std::function<void(uint32_t, const T&)>& callback) const {
+            directory->scan(lo, hi, callback);
+        }
+        void forEach(const std::function<void(uint32_t, const T&)>& callback, size_t threads = 0) const {
+            directory->forEach(callback, threads);
+        }
+        template <typename R, typename Map, typename Combine>
+        R reduce(R identity, Map map, Combine combine, size_t threads = 0) const {
+            return directory->reduce(std::move(identity), map, combine, threads);
+        }
+        [[nodiscard]] FrozenTable<T> freeze() const { return directory->freeze(); }
+        uint8_t getGlobalDepth() const { return directory->getGlobalDepth(); }
+
+    private:
+        explicit Snapshot(std::shared_ptr<const GlobalDirectory> directory) : directory(std::move(directory)) {}
+
+        std::shared_ptr<const GlobalDirectory> directory;
+
+        friend class GlobalDirectory;
+    };
+
     // Singleton pattern
     static GlobalDirectory& getInstance() {
         static GlobalDirectory instance;
@@ -21,18 +88,121 @@ public:
     bool initialize(const std::shared_ptr<Bucket<T>>& initialFile);
 
     [[nodiscard]] bool write(const uint32_t key, const T& data);
+    [[nodiscard]] bool write(const uint32_t key, T&& data);
+    // Replaces the value of an existing key in place, false if the key is absent
+    [[nodiscard]] bool update(const uint32_t key, const T& data);
+    [[nodiscard]] bool update(const uint32_t key, T&& data);
     [[nodiscard]] bool erase(const uint32_t key);
 
     void display() const;
     [[nodiscard]] std::optional<T> find(const uint32_t key) const;
+    [[nodiscard]] const T* get(const uint32_t key) const;
+
+    // Calls visitor with the data of the key in place, probing the same buckets as find
+    template <typename Visitor>
+    bool visit(const uint32_t key, Visitor&& visitor) const {
+        if (entry->empty()) return false; // Not initialized
+
+        const uint32_t index = hash(key);
+        const Bucket<T>& home = *(*entry)[index];
+        if (home.visit(key, visitor)) return true;
+        if (insertionMode == InsertionMode::SINGLE) return false;
+
+        if ((*entry)[neighbourOf(index)]->visit(key, visitor)) return true;
+        return home.getOverflowCount() > 0 && (*stash)[stashOf(key)]->visit(key, visitor);
+    }
+    void scan(const uint32_t lo, const uint32_t hi, const std::function<void(uint32_t, const T&)>& callback) const;
+
+    BucketIterator begin() const { return BucketIterator(*this, 0); }
+    BucketIterator end() const { return BucketIterator(*this, entry->size() + stash->size()); }
+
+    size_t forEachBucket(const std::function<void(size_t, const Bucket<T>&)>& callback, size_t threads = 0) const;
+    void forEach(const std::function<void(uint32_t, const T&)>& callback, size_t threads = 0) const;
+
+    // Folds map(key, data) over every entry with combine, one partial result per worker.
+    // combine must be associative and commutative as workers finish in any order.
+    template <typename R, typename Map, typename Combine>
+    R reduce(R identity, Map map, Combine combine, size_t threads = 0) const {
+        return reduceBuckets(*this, std::move(identity), map, combine, threads);
+    }
+    // Workers forEachBucket runs for a requested thread count, 0 for one per hardware thread
+    size_t workerCount(const size_t threads) const;
+
+    // Compacts the live entries into an immutable, pointer-free copy
+    [[nodiscard]] FrozenTable<T> freeze() const { return FrozenTable<T>::from(*this); }
+
+    // Constant-time copy-on-write view, must not race with writes to the live directory.
+    // Later writes copy only the directory and stash segments and the buckets they modify.
+    [[nodiscard]] Snapshot snapshot();
 
     uint8_t getGlobalDepth() const { return globalDepth; }
 
+    bool setInsertionMode(const InsertionMode mode);
+    InsertionMode getInsertionMode() const { return insertionMode; }
+    double getLoadFactor() const;
+
+    // Cache mode: once the budget is reached, full buckets evict instead of growing (0 disables)
+    void setMemoryBudget(const size_t bytes) { memoryBudget = bytes; }
+    size_t getMemoryBudget() const { return memoryBudget; }
+    size_t getMemoryUsage() const;
+    size_t getEvictionCount() const { return evictions; }
+
     // Deleted copy constructor and assignment operator
     GlobalDirectory(const GlobalDirectory&) = delete;
     GlobalDirectory& operator=(const GlobalDirectory&) = delete;
 
 private:
+    // Array of bucket pointers split into segments of up to 2^DIRECTORY_SEGMENT_BITS slots,
+    // used for the directory and the stash. Tables and segments are shared with snapshots:
+    // copying a table only copies its list of segments, and set() copies a segment the
+    // first time one of its slots changes. Segments follow the page mode of HugePageArena.
+    class SlotTable {
+    public:
+        using Segment = std::vector<std::shared_ptr<Bucket<T>>, HugePageAllocator<std::shared_ptr<Bucket<T>>>>;
+
+        SlotTable() = default;
+        explicit SlotTable(const size_t count) : count(count) {
+            const size_t length = std::min<size_t>(count, (size_t)1 << DIRECTORY_SEGMENT_BITS);
+            segments.reserve(count / std::max<size_t>(length, 1));
+            bases.reserve(segments.capacity());
+            for (size_t i = 0; i < count; i += length) {
+                segments.push_back(std::make_shared<Segment>(length));
+                bases.push_back(segments.back()->data());
+            }
+        }
+
+        const std::shared_ptr<Bucket<T>>& operator[](const size_t index) const {
+            return bases[index >> DIRECTORY_SEGMENT_BITS][index & SEGMENT_MASK];
+        }
+
+        // Points a slot at a bucket, copying its segment first if a snapshot still shares it
+        void set(const size_t index, const std::shared_ptr<Bucket<T>>& bucket) {
+            std::shared_ptr<Segment>& segment = segments[index >> DIRECTORY_SEGMENT_BITS];
+            if (segment.use_count() > 1) {
+                segment = std::make_shared<Segment>(*segment);
+                bases[index >> DIRECTORY_SEGMENT_BITS] = segment->data();
+            } else {
+                // The last snapshot may have been released by a reader, order its reads before our writes
+                std::atomic_thread_fence(std::memory_order_acquire);
+            }
+            (*segment)[index & SEGMENT_MASK] = bucket;
+        }
+
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        size_t memoryBytes() const {
+            return count * sizeof(std::shared_ptr<Bucket<T>>) +
+                   segments.size() * (sizeof(std::shared_ptr<Segment>) + sizeof(std::shared_ptr<Bucket<T>>*));
+        }
+
+    private:
+        static constexpr size_t SEGMENT_MASK = ((size_t)1 << DIRECTORY_SEGMENT_BITS) - 1;
+
+        std::vector<std::shared_ptr<Segment>> segments;
+        std::vector<std::shared_ptr<Bucket<T>>*> bases;  // segments[i]->data(), saves a load per lookup
+        size_t count{ 0 };
+    };
+
     // Private constructor
     GlobalDirectory() = default;
 
@@ -46,7 +216,39 @@ private:
     [[nodiscard]] bool splitOn(const uint32_t hashValue);
 
     uint32_t hash(const uint32_t key) const;
+    uint32_t slotsOf(const size_t index) const;
+    uint32_t neighbourOf(const uint32_t index) const;
+    uint32_t stashOf(const uint32_t key) const;
+
+    // Copy-on-write of the directory and stash tables and of buckets shared with snapshots
+    void ownEntries();
+    void ownStash();
+    bool isShared(const Bucket<T>& bucket) const;
+    const std::shared_ptr<Bucket<T>>& writable(const uint32_t index);
+    const std::shared_ptr<Bucket<T>>& writableStash(const size_t position);
+    [[nodiscard]] bool eraseAt(const uint32_t index, const uint32_t key);
+
+    [[nodiscard]] bool place(const uint32_t index, const uint32_t key, T&& data);
+    [[nodiscard]] bool relocateDisplaced(const std::shared_ptr<Bucket<T>>& neighbour, const uint32_t neighbourKey,
+                                         const uint32_t lo, const uint32_t hi);
+    void adjustOverflow(const uint32_t index, const int delta);
+    void recountOverflow(const uint32_t index);
+    void growStash();
+    size_t growthCost(const uint32_t hashValue) const;
+    static size_t bucketBytes();
 
     uint8_t globalDepth{ 0 };
-    std::vector<std::shared_ptr<Bucket<T>>> entry;
+    std::shared_ptr<SlotTable> entry{ std::make_shared<SlotTable>() };  // shared with snapshots
+
+    InsertionMode insertionMode{ InsertionMode::SINGLE };
+    // Overflow buckets of BALANCED mode, indexed by stashOf, shared with snapshots
+    std::shared_ptr<SlotTable> stash{ std::make_shared<SlotTable>() };
+    uint8_t stashDepth{ 0 };    // stash->size() == 2^stashDepth once initialized
+
+    size_t bucketCount{ 0 };
+    size_t memoryBudget{ 0 };
+    size_t evictions{ 0 };
+
+    uint32_t epoch{ 0 };    // buckets stamped with an older epoch may be read by a snapshot
+    std::shared_ptr<const int> snapshotRefs{ std::make_shared<const int>(0) };  // copied by every snapshot
 };
@@ -0,0 +1,241 @@
+#include <algorithm>
+
+#include "HugePageAllocator.hpp"
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// From <linux/mempolicy.h>, spelled out to avoid depending on libnuma headers
+#define NUMA_MPOL_BIND 2
+#define NUMA_MPOL_INTERLEAVE 3
+#define NUMA_MAX_NODES 64
+#endif
+
+/**
+ * @brief Selects how later allocations are backed.
+ *
+ * @param mode Whether to use operator new, transparent huge pages or explicit huge pages.
+ * @param policy How mapped pages are spread across NUMA nodes.
+ * @param node The NUMA node used by NumaPolicy::BIND.
+ */
+void HugePageArena::configure(const PageMode mode, const NumaPolicy policy, const int node) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->mode = mode;
+    numaPolicy = policy;
+    numaNode = node;
+}
+
+HugePageArena::Stats HugePageArena::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+/**
+ * @brief Allocates at least the requested number of bytes, 16 byte aligned.
+ *
+ * Small requests are served from the free list of their size class or bumped out
+ * of the current shared chunk; large requests get a dedicated huge page mapping.
+ * If mapping fails, or the arena is in DEFAULT mode, operator new is used; the
+ * mode is checked before locking so that DEFAULT mode never contends on the arena.
+ *
+ * @param bytes The number of bytes to allocate.
+ * @return A pointer to the allocated memory.
+ */
+void* HugePageArena::allocate(const size_t bytes) {
+    if (mode.load(std::memory_order_relaxed) == PageMode::DEFAULT) return ::operator new(bytes);
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (bytes > HUGE_PAGE_SMALL_LIMIT) {
+        const size_t length = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        void* base = map(length);
+        if (!base) return ::operator new(bytes);
+
+        addMapping(Mapping{ static_cast<char*>(base), length, false });
+        return base;
+    }
+
+    const size_t sizeIndex = sizeClass(bytes);
+    if (sizeIndex < freeLists.size() && freeLists[sizeIndex]) {
+        void* block = freeLists[sizeIndex];
+        freeLists[sizeIndex] = *static_cast<void**>(block);
+        return block;
+    }
+
+    const size_t rounded = sizeIndex * 16;
+    if (!cursor || cursor + rounded > chunkEnd) {
+        void* base = map(HUGE_PAGE_SIZE);
+        if (!base) return ::operator new(bytes);
+
+        addMapping(Mapping{ static_cast<char*>(base), HUGE_PAGE_SIZE, true });
+        cursor = static_cast<char*>(base);
+        chunkEnd = cursor + HUGE_PAGE_SIZE;
+    }
+    void* block = cursor;
+    cursor += rounded;
+    return block;
+}
+
+/**
+ * @brief Releases memory obtained from allocate.
+ *
+ * Blocks carved from a shared chunk go back to their size class free list, dedicated
+ * mappings are unmapped, and anything else was obtained from operator new.
+ * While no mapping was ever created every pointer came from operator new, so the
+ * lock and the mapping lookup are skipped entirely.
+ *
+ * @param ptr The pointer returned by allocate.
+ * @param bytes The size passed to allocate.
+ */
+void HugePageArena::deallocate(void* ptr, const size_t bytes) {
+    if (!ptr) return;
+    if (!mapped.load(std::memory_order_acquire)) {
+        ::operator delete(ptr);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    const Mapping* mapping = owner(ptr);
+    if (!mapping) {
+        ::operator delete(ptr);
+        return;
+    }
+
+    if (mapping->shared) {
+        const size_t sizeIndex = sizeClass(bytes);
+        if (sizeIndex >= freeLists.size()) {
+            freeLists.resize(sizeIndex + 1, nullptr);
+        }
+        *static_cast<void**>(ptr) = freeLists[sizeIndex];
+        freeLists[sizeIndex] = ptr;
+        return;
+    }
+
+    unmap(mapping->base, mapping->length);
+    mappings.erase(mappings.begin() + (mapping - mappings.data()));
+}
+
+/**
+ * @brief Records a new mapping, keeping the mappings sorted by base address.
+ *
+ * The release store pairs with the acquire load in deallocate: a thread releasing a
+ * pointer carved from this mapping received it after this store, so it takes the
+ * locked path that routes the pointer back to the mapping.
+ *
+ * @param mapping The mapping to record, the caller holds the lock.
+ */
+void HugePageArena::addMapping(const Mapping& mapping) {
+    mappings.insert(std::upper_bound(mappings.begin(), mappings.end(), mapping,
+                    [](const Mapping& a, const Mapping& b) { return a.base < b.base; }), mapping);
+    mapped.store(true, std::memory_order_release);
+}
+
+/**
+ * @brief Finds the arena mapping containing a pointer.
+ *
+ * @param ptr The pointer to look up.
+ * @return The mapping containing ptr, or nullptr if it came from operator new.
+ */
+const HugePageArena::Mapping* HugePageArena::owner(const void* ptr) const {
+    const char* address = static_cast<const char*>(ptr);
+    auto it = std::upper_bound(mappings.begin(), mappings.end(), address,
+                               [](const char* a, const Mapping& m) { return a < m.base; });
+    if (it == mappings.begin()) return nullptr;
+    --it;
+    return address < it->base + it->length ? &*it : nullptr;
+}
+
+/**
+ * @brief Maps a HUGE_PAGE_SIZE multiple of memory according to the current mode.
+ *
+ * EXPLICIT mode first tries MAP_HUGETLB, which needs pages reserved in
+ * /proc/sys/vm/nr_hugepages. Otherwise, or on failure, an over-sized anonymous
+ * mapping is trimmed to a 2 MiB aligned range and advised with MADV_HUGEPAGE so
+ * the kernel can back it with transparent huge pages.
+ *
+ * @param length The length to map, a multiple of HUGE_PAGE_SIZE.
+ * @return The base of the mapping, or nullptr if nothing could be mapped.
+ */
+void* HugePageArena::map(const size_t length) {
+#ifdef __linux__
+    if (mode == PageMode::EXPLICIT) {
+        void* base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (base != MAP_FAILED) {
+            stats.hugeTlbBytes += length;
+            applyNumaPolicy(base, length);
+            return base;
+        }
+        stats.fallbacks++;
+    }
+
+    void* raw = mmap(nullptr, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) return nullptr;
+
+    // Trim the mapping so that it starts and ends on a huge page boundary
+    char* begin = static_cast<char*>(raw);
+    char* aligned = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(begin) + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1));
+    if (aligned > begin) munmap(begin, aligned - begin);
+    const size_t tail = begin + length + HUGE_PAGE_SIZE - (aligned + length);
+    if (tail > 0) munmap(aligned + length, tail);
+
+#ifdef MADV_HUGEPAGE
+    if (madvise(aligned, length, MADV_HUGEPAGE) == 0) {
+        stats.transparentBytes += length;
+    } else {
+        stats.fallbacks++;
+    }
+#else
+    stats.fallbacks++;
+#endif
+    applyNumaPolicy(aligned, length);
+    return aligned;
+#else
+    (void)length;
+    return nullptr;
+#endif
+}
+
+void HugePageArena::unmap(void* base, const size_t length) {
+#ifdef __linux__
+    munmap(base, length);
+#else
+    (void)base;
+    (void)length;
+#endif
+}
+
+/**
+ * @brief Applies the configured NUMA policy to a fresh mapping.
+ *
+ * Uses the mbind system call directly. On single node machines, kernels built
+ * without NUMA support or invalid nodes, the call fails and the kernel's default
+ * first-touch placement is kept.
+ *
+ * @param base The base of the mapping.
+ * @param length The length of the mapping.
+ */
+void HugePageArena::applyNumaPolicy(void* base, const size_t length) {
+#ifdef __linux__
+    if (numaPolicy == NumaPolicy::NONE) return;
+
+    unsigned long nodeMask = 0;
+    int policy = NUMA_MPOL_INTERLEAVE;
+    if (numaPolicy == NumaPolicy::INTERLEAVE) {
+        nodeMask = ~0UL;
+    } else if (numaNode >= 0 && numaNode < NUMA_MAX_NODES) {
+        nodeMask = 1UL << numaNode;
+        policy = NUMA_MPOL_BIND;
+    }
+
+    if (nodeMask && syscall(SYS_mbind, base, length, policy, &nodeMask, NUMA_MAX_NODES, 0) == 0) {
+        stats.numaBoundBytes += length;
+    } else {
+        stats.fallbacks++;
+    }
+#else
+    (void)base;
+    (void)length;
+#endif
+}
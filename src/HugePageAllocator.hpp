@@ -0,0 +1,131 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <new>
+
+// Size of the chunks the arena maps, one 2 MiB huge page on x86-64 and arm64
+#define HUGE_PAGE_SIZE ((size_t)2 << 20)
+// Allocations up to this size are carved out of shared chunks, larger ones get their own mapping
+#define HUGE_PAGE_SMALL_LIMIT ((size_t)64 << 10)
+
+enum class PageMode {
+    DEFAULT,        // plain operator new
+    TRANSPARENT,    // 2 MiB aligned mappings advised with MADV_HUGEPAGE
+    EXPLICIT        // MAP_HUGETLB mappings, falling back to TRANSPARENT when none are reserved
+};
+
+enum class NumaPolicy {
+    NONE,           // first-touch placement chosen by the kernel
+    INTERLEAVE,     // pages interleaved across all NUMA nodes
+    BIND            // pages bound to a single NUMA node
+};
+
+/**
+ * @class HugePageArena
+ * @brief Backs directory arrays and buckets with huge pages on request.
+ *
+ * In DEFAULT mode every request goes to operator new. Otherwise memory is mapped in
+ * HUGE_PAGE_SIZE chunks, small allocations are carved out of those chunks and recycled
+ * through per-size free lists, and large allocations get a dedicated mapping. Every
+ * mapping can additionally be interleaved or bound across NUMA nodes. When a huge page
+ * or NUMA request is refused by the kernel, the arena silently degrades to normal pages.
+ * Pointers are routed back to the right allocator on release, so the mode may be
+ * changed at any time; it only affects later allocations. Until the first mapping is
+ * created, allocate and deallocate go straight to operator new and delete without
+ * taking the lock.
+ */
+class HugePageArena {
+public:
+    struct Stats {
+        size_t hugeTlbBytes{ 0 };       // bytes mapped with MAP_HUGETLB
+        size_t transparentBytes{ 0 };   // bytes mapped and advised with MADV_HUGEPAGE
+        size_t numaBoundBytes{ 0 };     // bytes the NUMA policy was applied to
+        size_t fallbacks{ 0 };          // huge page or NUMA requests refused by the kernel
+    };
+
+    // Singleton pattern, intentionally never destroyed so that buckets released by
+    // other singletons during static destruction can still be handed back
+    static HugePageArena& getInstance() {
+        static HugePageArena* instance = new HugePageArena();
+        return *instance;
+    }
+
+    void configure(const PageMode mode, const NumaPolicy policy = NumaPolicy::NONE, const int node = 0);
+
+    [[nodiscard]] void* allocate(const size_t bytes);
+    void deallocate(void* ptr, const size_t bytes);
+
+    PageMode getMode() const { return mode.load(std::memory_order_relaxed); }
+    NumaPolicy getNumaPolicy() const { return numaPolicy.load(std::memory_order_relaxed); }
+    Stats getStats() const;
+
+    // Deleted copy constructor and assignment operator
+    HugePageArena(const HugePageArena&) = delete;
+    HugePageArena& operator=(const HugePageArena&) = delete;
+
+private:
+    struct Mapping {
+        char* base;
+        size_t length;
+        bool shared;    // carved into small allocations, never unmapped
+    };
+
+    // Private constructor
+    HugePageArena() = default;
+
+    void* map(const size_t length);
+    void unmap(void* base, const size_t length);
+    void applyNumaPolicy(void* base, const size_t length);
+    const Mapping* owner(const void* ptr) const;
+
+    static size_t sizeClass(const size_t bytes) { return (bytes + 15) / 16; }
+
+    void addMapping(const Mapping& mapping);
+
+    std::atomic<PageMode> mode{ PageMode::DEFAULT };
+    std::atomic<NumaPolicy> numaPolicy{ NumaPolicy::NONE };
+    int numaNode{ 0 };
+    std::atomic<bool> mapped{ false };      // set once the first mapping exists, never cleared
+
+    mutable std::mutex mutex;
+    std::vector<Mapping> mappings;          // sorted by base address
+    std::vector<void*> freeLists;           // indexed by sizeClass, singly linked through the blocks
+    char* cursor{ nullptr };                // bump pointer inside the current shared chunk
+    char* chunkEnd{ nullptr };
+    Stats stats;
+};
+
+/**
+ * @class HugePageAllocator
+ * @brief A standard allocator that forwards to HugePageArena.
+ *
+ * Used for the directory vector, the radix trie nodes and, through Bucket::make, for the buckets themselves.
+ *
+ * @tparam U The type of the allocated objects.
+ */
+template <typename U>
+class HugePageAllocator {
+public:
+    using value_type = U;
+
+    HugePageAllocator() = default;
+    template <typename V>
+    HugePageAllocator(const HugePageAllocator<V>&) {}
+
+    U* allocate(const size_t n) {
+        static_assert(alignof(U) <= 16, "HugePageArena only guarantees 16 byte alignment");
+        return static_cast<U*>(HugePageArena::getInstance().allocate(n * sizeof(U)));
+    }
+
+    void deallocate(U* ptr, const size_t n) {
+        HugePageArena::getInstance().deallocate(ptr, n * sizeof(U));
+    }
+
+    template <typename V>
+    bool operator==(const HugePageAllocator<V>&) const { return true; }
+    template <typename V>
+    bool operator!=(const HugePageAllocator<V>&) const { return false; }
+};
@@ -40,6 +40,15 @@ int main() {
     addCommand(new WriteCommand<DATA_TYPE>(37, 1, true));
     addCommand(new SearchCommand<DATA_TYPE>(13, true));
     addCommand(new DisplayCommand<DATA_TYPE>());
+    addCommand(new ScanCommand<DATA_TYPE>(0, 50, 6));
+    addCommand(new ScanCommand<DATA_TYPE>(100, 255, 4));
+    addCommand(new AggregateCommand<DATA_TYPE>(10));
+    addCommand(new AggregateCommand<DATA_TYPE>(10, 3));
+    addCommand(new WriteCommand<DATA_TYPE>(MAX_KEY_VALUE + 1, 7, false));
+    addCommand(new FreezeCommand<DATA_TYPE>(10));
+#ifndef COMPACT_DIRECTORY // MemoryManager::snapshot() does not compile for RadixDirectory
+    addCommand(new SnapshotCommand<DATA_TYPE>(200, 20));
+#endif
     //================================================
     addCommand(new EraseCommand<DATA_TYPE>(14, true));
     addCommand(new EraseCommand<DATA_TYPE>(13, true));
@@ -49,6 +58,18 @@ int main() {
     addCommand(new DisplayCommand<DATA_TYPE>());
     addCommand(new WriteCommand<DATA_TYPE>(3, 9, true));
     addCommand(new DisplayCommand<DATA_TYPE>());
+    //================================================
+    // cache mode: writes evict within the full bucket instead of growing
+    addCommand(new CacheModeCommand<DATA_TYPE>());
+    addCommand(new WriteCommand<DATA_TYPE>(4, 40, true));
+    addCommand(new WriteCommand<DATA_TYPE>(5, 50, true));
+    addCommand(new SearchCommand<DATA_TYPE>(4, true));
+    addCommand(new WriteCommand<DATA_TYPE>(6, 60, true));
+    addCommand(new SearchCommand<DATA_TYPE>(4, true));
+    addCommand(new SearchCommand<DATA_TYPE>(5, false));
+    addCommand(new SearchCommand<DATA_TYPE>(6, true));
+    addCommand(new DisplayCommand<DATA_TYPE>());
+    addCommand(new CacheStatsCommand<DATA_TYPE>(1));
 
     // Execute each command in the commands vector
     for (const auto& command : commands) {
@@ -3,6 +3,7 @@
 
 #include "MemoryManager.hpp"
 #include "Bucket.hpp"
+#include "CountedValue.hpp"
 
 /**
  * @brief Displays the current state of the MemoryManager.
@@ -13,8 +14,8 @@
  * and calls the display function of the initial file. Otherwise, it calls the display function of the global directory.
  * Finally, it prints a footer to indicate the end of the display.
  */
-template <typename T>
-void MemoryManager<T>::display() const {
+template <typename T, typename Directory>
+void MemoryManager<T, Directory>::display() const {
     std::cout << "########## Start of MemoryManager Display ##########\n";
     if(globalDirectory.getGlobalDepth() == 0) {
         std::cout << "Initial File\n";
@@ -27,6 +28,40 @@ void MemoryManager<T>::display() const {
     std::cout << "########## End of MemoryManager Display ##########\n";
 }
 
+/**
+ * @brief Finds the data associated with a key in the memory manager.
+ *
+ * If the global directory's depth is zero, the initial file is searched; otherwise
+ * the global directory is. Every lookup is counted as a hit or a miss and marks the
+ * entry as recently used for cache mode eviction.
+ *
+ * @tparam T The type of the value associated with the key.
+ * @param key The key to search for.
+ * @return std::optional<T> The data associated with the key if found, or std::nullopt if not found.
+ */
+template <typename T, typename Directory>
+std::optional<T> MemoryManager<T, Directory>::find(const uint32_t key) const {
+    std::optional<T> result;
+    visit(key, [&result](const T& data) { result = data; });
+    return result;
+}
+
+/**
+ * @brief Returns a pointer to the data associated with a key, without copying it.
+ *
+ * The lookup is counted and marks the entry as recently used, like find.
+ *
+ * @tparam T The type of the value associated with the key.
+ * @param key The key to search for.
+ * @return A pointer to the data, valid until the next write or erase, or nullptr if not found.
+ */
+template <typename T, typename Directory>
+const T* MemoryManager<T, Directory>::get(const uint32_t key) const {
+    const T* result = nullptr;
+    visit(key, [&result](const T& data) { result = &data; });
+    return result;
+}
+
 /**
  * @brief Searches for a given key in the memory manager and prints the result.
  *
@@ -39,20 +74,15 @@ void MemoryManager<T>::display() const {
  * @param key The key to search for.
  * @return true if the key is found, false otherwise.
  */
-template<typename T>
-bool MemoryManager<T>::searchAndPrint(const uint32_t key) const {
-    const auto& result = (globalDirectory.getGlobalDepth() == 0) 
-                         ? initialFile->find(key) 
-                         : globalDirectory.find(key);
-
+template <typename T, typename Directory>
+bool MemoryManager<T, Directory>::searchAndPrint(const uint32_t key) const {
     std::cout << "Search for Key: " << std::bitset<MAX_KEY_LENGTH>(key) << " Value: ";
-    if (result.has_value()) {
-        std::cout << result.value() << std::endl;
-    } else {
+    const bool found = visit(key, [](const T& data) { std::cout << data << std::endl; });
+    if (!found) {
         std::cout << "Not found" << std::endl;
     }
 
-    return result.has_value();
+    return found;
 }
 
 
@@ -70,16 +100,69 @@ bool MemoryManager<T>::searchAndPrint(const uint32_t key) const {
  * @param data The data to be written.
  * @return true if the data was successfully written, false otherwise.
  */
-template <typename T>
-bool MemoryManager<T>::write(const uint32_t key, const T& data) {
+template <typename T, typename Directory>
+bool MemoryManager<T, Directory>::write(const uint32_t key, const T& data) {
+    return write(key, T(data));
+}
+
+/**
+ * @brief Moves data into the memory manager using a specified key.
+ *
+ * Same as the copying overload, but the data is moved into its bucket. A full
+ * initial file leaves data untouched, so it is still available for the directory.
+ * Keys wider than MAX_KEY_LENGTH bits are rejected, as scans and freeze() only
+ * cover [0, MAX_KEY_VALUE].
+ *
+ * @tparam T The type of data to be written.
+ * @param key The key associated with the data to be written.
+ * @param data The data to be moved into the memory manager.
+ * @return true if the data was successfully written, false otherwise.
+ */
+template <typename T, typename Directory>
+bool MemoryManager<T, Directory>::write(const uint32_t key, T&& data) {
+    if (key > MAX_KEY_VALUE) return false;
+
     if (globalDirectory.getGlobalDepth() == 0) {
-        if (initialFile->write(key, data)) {
+        if (initialFile->write(key, std::move(data))) {
             return true; // Success
         }
         globalDirectory.initialize(initialFile);
     }
 
-    return globalDirectory.write(key, data);;
+    return globalDirectory.write(key, std::move(data));
+}
+
+/**
+ * @brief Replaces the value of an existing key with a copy of data.
+ *
+ * @tparam T The type of data to be written.
+ * @param key The key of the entry to update.
+ * @param data The new value.
+ * @return true if the key was found and updated, false otherwise.
+ */
+template <typename T, typename Directory>
+bool MemoryManager<T, Directory>::update(const uint32_t key, const T& data) {
+    return update(key, T(data));
+}
+
+/**
+ * @brief Replaces the value of an existing key in place.
+ *
+ * If the global directory's depth is 0, the initial file is updated; otherwise
+ * the global directory is. Nothing is written when the key is absent, so callers
+ * implementing an upsert write only after update returned false.
+ *
+ * @tparam T The type of data to be written.
+ * @param key The key of the entry to update.
+ * @param data The new value, only moved from if the key was found.
+ * @return true if the key was found and updated, false otherwise.
+ */
+template <typename T, typename Directory>
+bool MemoryManager<T, Directory>::update(const uint32_t key, T&& data) {
+    if (globalDirectory.getGlobalDepth() == 0) {
+        return initialFile->update(key, std::move(data));
+    }
+    return globalDirectory.update(key, std::move(data));
 }
 
 /**
@@ -93,8 +176,8 @@ bool MemoryManager<T>::write(const uint32_t key, const T& data) {
  * @param key The key of the entry to be erased.
  * @return true if the entry was successfully erased, false otherwise.
  */
-template <typename T>
-bool MemoryManager<T>::erase(const uint32_t key) {
+template <typename T, typename Directory>
+bool MemoryManager<T, Directory>::erase(const uint32_t key) {
     if (globalDirectory.getGlobalDepth() == 0) {
         return initialFile->erase(key);
     }
@@ -102,4 +185,64 @@ bool MemoryManager<T>::erase(const uint32_t key) {
     return globalDirectory.erase(key);
 }
 
-template class MemoryManager<int>;
+/**
+ * @brief Visits every entry with a key in [lo, hi] in ascending key order.
+ *
+ * If the global directory's depth is zero, the initial file is scanned;
+ * otherwise the scan is delegated to the global directory.
+ *
+ * @tparam T The type of the elements managed by the memory manager.
+ * @param lo The smallest key to visit (inclusive).
+ * @param hi The largest key to visit (inclusive).
+ * @param callback Invoked with the key and data of every matching entry.
+ */
+template <typename T, typename Directory>
+void MemoryManager<T, Directory>::scan(const uint32_t lo, const uint32_t hi, const std::function<void(uint32_t, const T&)>& callback) const {
+    if (globalDirectory.getGlobalDepth() == 0) {
+        initialFile->scan(lo, hi, callback);
+    } else {
+        globalDirectory.scan(lo, hi, callback);
+    }
+}
+
+/**
+ * @brief Visits every entry of the memory manager exactly once.
+ *
+ * Before the global directory exists, the initial file is visited on the calling
+ * thread; afterwards the visit is split across worker threads by the directory,
+ * so the callback must be safe to call concurrently.
+ *
+ * @tparam T The type of the elements managed by the memory manager.
+ * @param callback Invoked with the key and data of every entry.
+ * @param threads The number of workers to use, 0 for one per hardware thread.
+ */
+template <typename T, typename Directory>
+void MemoryManager<T, Directory>::forEach(const std::function<void(uint32_t, const T&)>& callback, size_t threads) const {
+    if (globalDirectory.getGlobalDepth() == 0) {
+        initialFile->forEach(callback);
+    } else {
+        globalDirectory.forEach(callback, threads);
+    }
+}
+
+/**
+ * @brief Reports the lookup hit rate, the evictions and the memory use of the cache.
+ *
+ * @tparam T The type of the elements managed by the memory manager.
+ * @return A snapshot of the cache counters.
+ */
+template <typename T, typename Directory>
+CacheStats MemoryManager<T, Directory>::getCacheStats() const {
+    CacheStats stats;
+    stats.hits = hits.load(std::memory_order_relaxed);
+    stats.misses = misses.load(std::memory_order_relaxed);
+    stats.evictions = globalDirectory.getEvictionCount();
+    stats.memoryUsage = globalDirectory.getMemoryUsage();
+    stats.memoryBudget = globalDirectory.getMemoryBudget();
+    return stats;
+}
+
+template class MemoryManager<int, GlobalDirectory<int>>;
+template class MemoryManager<int, RadixDirectory<int>>;
+template class MemoryManager<CountedValue, GlobalDirectory<CountedValue>>;
+template class MemoryManager<CountedValue, RadixDirectory<CountedValue>>;
@@ -1,9 +1,34 @@
 #pragma once
+#include <atomic>
+#include <type_traits>
 
 #include "GlobalDirectory.hpp"
+#include "RadixDirectory.hpp"
 #include "Common.hpp"
+#include "Bucket.hpp"
+#include "FrozenTable.hpp"
 
+// Build with -DCOMPACT_DIRECTORY to back MemoryManager with RadixDirectory by default
+#ifdef COMPACT_DIRECTORY
 template <typename T>
+using DefaultDirectory = RadixDirectory<T>;
+#else
+template <typename T>
+using DefaultDirectory = GlobalDirectory<T>;
+#endif
+
+// Lookup and eviction counters reported in cache mode
+struct CacheStats {
+    size_t hits{ 0 };
+    size_t misses{ 0 };
+    size_t evictions{ 0 };
+    size_t memoryUsage{ 0 };
+    size_t memoryBudget{ 0 };
+
+    double hitRate() const { return hits + misses == 0 ? 0.0 : (double)hits / (hits + misses); }
+};
+
+template <typename T, typename Directory = DefaultDirectory<T>>
 class MemoryManager {
 public:
     static MemoryManager& getInstance() {
@@ -11,13 +36,67 @@ public:
         return instance;
     }
 
+    // The rvalue overloads move the value into its slot, and splits and merges move it again,
+    // so it is never copied unless a snapshot shares its bucket; the const T& overloads copy once
     [[nodiscard]] bool write(const uint32_t key, const T& data);
+    [[nodiscard]] bool write(const uint32_t key, T&& data);
+    // Replaces the value of an existing key in place, false if the key is absent
+    [[nodiscard]] bool update(const uint32_t key, const T& data);
+    [[nodiscard]] bool update(const uint32_t key, T&& data);
     [[nodiscard]] bool erase(const uint32_t key);
 
+    [[nodiscard]] std::optional<T> find(const uint32_t key) const;
+    [[nodiscard]] const T* get(const uint32_t key) const;
+
+    // Calls visitor with the data of the key in place; counted and marked like find
+    template <typename Visitor>
+    bool visit(const uint32_t key, Visitor&& visitor) const {
+        const bool found = (globalDirectory.getGlobalDepth() == 0)
+                           ? initialFile->visit(key, visitor)
+                           : globalDirectory.visit(key, visitor);
+        (found ? hits : misses).fetch_add(1, std::memory_order_relaxed);
+        return found;
+    }
     [[nodiscard]] bool searchAndPrint(const uint32_t key) const;
+    void scan(const uint32_t lo, const uint32_t hi, const std::function<void(uint32_t, const T&)>& callback) const;
+
+    void forEach(const std::function<void(uint32_t, const T&)>& callback, size_t threads = 0) const;
+
+    template <typename R, typename Map, typename Combine>
+    R reduce(R identity, Map map, Combine combine, size_t threads = 0) const {
+        if (globalDirectory.getGlobalDepth() != 0) {
+            return globalDirectory.reduce(std::move(identity), map, combine, threads);
+        }
+        R result = std::move(identity);
+        initialFile->forEach([&](uint32_t key, const T& data) {
+            result = combine(std::move(result), map(key, data));
+        });
+        return result;
+    }
 
     void display() const;
 
+    // Compacts the live entries, initial file included, into an immutable, pointer-free copy
+    [[nodiscard]] FrozenTable<T> freeze() const { return FrozenTable<T>::from(*this); }
+
+    // Constant-time copy-on-write view of the table, see GlobalDirectory::snapshot. During the initial
+    // file phase the directory is created first, so the view holds the initial entries too
+    // (and the insertion mode can no longer change). Only GlobalDirectory supports snapshots:
+    // a template so that RadixDirectory managers still instantiate, but fail to call it.
+    template <typename D = Directory>
+    [[nodiscard]] auto snapshot() {
+        static_assert(std::is_same_v<D, GlobalDirectory<T>>, "MemoryManager::snapshot() requires GlobalDirectory");
+        if (globalDirectory.getGlobalDepth() == 0) {
+            globalDirectory.initialize(initialFile);
+        }
+        return globalDirectory.snapshot();
+    }
+
+    // Cache mode: bounds the directory to budgetBytes, full buckets then evict with CLOCK
+    void enableCacheMode(const size_t budgetBytes) { globalDirectory.setMemoryBudget(budgetBytes); }
+    size_t getMemoryUsage() const { return globalDirectory.getMemoryUsage(); }
+    CacheStats getCacheStats() const;
+
     // Deleted copy constructor and assignment operator
     MemoryManager(const MemoryManager&) = delete;
     MemoryManager& operator=(const MemoryManager&) = delete;
@@ -26,6 +105,9 @@ private:
     // Private constructor
     MemoryManager() = default;
 
-    GlobalDirectory<T>& globalDirectory = GlobalDirectory<T>::getInstance();
-    std::shared_ptr<Bucket<T>> initialFile = std::make_shared<Bucket<T>>();
+    Directory& globalDirectory = Directory::getInstance();
+    std::shared_ptr<Bucket<T>> initialFile = Bucket<T>::make();
+
+    mutable std::atomic<size_t> hits{ 0 };
+    mutable std::atomic<size_t> misses{ 0 };
 };
@@ -0,0 +1,35 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Number of workers for a parallel visit over `units` independent ranges:
+// 0 threads means one per hardware thread, never more workers than units, never fewer than one
+inline size_t resolveWorkerCount(const size_t threads, const size_t units) {
+    const size_t workers = threads ? threads : std::thread::hardware_concurrency();
+    return std::max<size_t>(1, std::min(workers, units));
+}
+
+// Folds map(key, data) over every entry of a directory with combine, one partial result per worker.
+// Directory provides workerCount(threads) and forEachBucket(callback(worker, bucket), threads),
+// as GlobalDirectory and RadixDirectory do.
+// combine must be associative and commutative as workers finish in any order.
+template <typename Directory, typename R, typename Map, typename Combine>
+R reduceBuckets(const Directory& directory, R identity, Map map, Combine combine, const size_t threads) {
+    struct alignas(64) Partial { R value; };
+    std::vector<Partial> partials(directory.workerCount(threads), Partial{ identity });
+    directory.forEachBucket([&](size_t worker, const auto& bucket) {
+        bucket.forEach([&](uint32_t key, const auto& data) {
+            partials[worker].value = combine(std::move(partials[worker].value), map(key, data));
+        });
+    }, threads);
+
+    R result = std::move(identity);
+    for (Partial& partial : partials) {
+        result = combine(std::move(result), std::move(partial.value));
+    }
+    return result;
+}
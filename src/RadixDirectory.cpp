@@ -0,0 +1,599 @@
+#include <iostream>
+#include <string>
+#include <iomanip>
+#include <algorithm>
+#include <thread>
+
+#include "RadixDirectory.hpp"
+#include "Bucket.hpp"
+#include "CountedValue.hpp"
+
+/**
+ * @brief Initializes the RadixDirectory with an initial file.
+ *
+ * This function creates the root node, points its lower and upper halves at two
+ * new buckets of local depth 1 and rehashes the items of the initial file into them.
+ *
+ * @tparam T The type of elements stored in the buckets.
+ * @param initialFile A shared pointer to the initial bucket containing items to be rehashed.
+ * @return true if the RadixDirectory was successfully initialized, false if it was already initialized.
+ */
+template <typename T>
+bool RadixDirectory<T>::initialize(const std::shared_ptr<Bucket<T>>& initialFile) {
+    if (root) return false; // already initialized
+
+    root = makeNode(0);
+    nodesPerLevel[0] = 1;
+    const size_t half = root->slotCount() / 2;
+    std::shared_ptr<Bucket<T>> lower = Bucket<T>::make(1);
+    std::shared_ptr<Bucket<T>> upper = Bucket<T>::make(1);
+    for (size_t i = 0; i < half; i++) {
+        root->slots[i].bucket = lower;
+        root->slots[i + half].bucket = upper;
+    }
+    bucketCount = 2;
+
+    return reHashItems(initialFile);
+}
+
+/**
+ * @brief Allocates an empty node of the given level from HugePageArena.
+ *
+ * @tparam T The type parameter for the RadixDirectory class.
+ * @param level The level of the node.
+ * @return The node, released through HugePageArena as well.
+ */
+template <typename T>
+typename RadixDirectory<T>::NodePtr RadixDirectory<T>::makeNode(const uint8_t level) {
+    Node* node = HugePageAllocator<Node>().allocate(1);
+    return NodePtr(new (node) Node(level));
+}
+
+template <typename T>
+uint32_t RadixDirectory<T>::bitsOf(const uint8_t level) {
+    return std::min(RADIX_STRIDE, MAX_KEY_LENGTH - baseDepth(level));
+}
+
+/**
+ * @brief Computes the slot a key falls into inside a node of the given level.
+ *
+ * The node at level l consumes the bitsOf(l) key bits that follow the first
+ * l * RADIX_STRIDE most significant bits, mirroring GlobalDirectory::hash.
+ *
+ * @tparam T The type parameter for the RadixDirectory class.
+ * @param key The key to locate.
+ * @param level The level of the node.
+ * @return The slot index inside the node.
+ */
+template <typename T>
+uint32_t RadixDirectory<T>::slotIndex(const uint32_t key, const uint8_t level) {
+    const uint32_t bits = bitsOf(level);
+    return ((key & MAX_KEY_VALUE) >> (MAX_KEY_LENGTH - baseDepth(level) - bits)) & ((1 << bits) - 1);
+}
+
+template <typename T>
+uint8_t RadixDirectory<T>::getGlobalDepth() const {
+    if (!root) return 0; // Not initialized
+
+    uint8_t level = RADIX_LEVELS - 1;
+    while (level > 0 && nodesPerLevel[level] == 0) {
+        level--;
+    }
+    return baseDepth(level) + bitsOf(level);
+}
+
+template <typename T>
+size_t RadixDirectory<T>::getNodeCount() const {
+    size_t count = 0;
+    for (size_t nodes : nodesPerLevel) {
+        count += nodes;
+    }
+    return count;
+}
+
+/**
+ * @brief Estimates the memory held by the trie nodes and the buckets.
+ *
+ * @tparam T The type parameter for the RadixDirectory class.
+ * @return The estimated number of bytes in use.
+ */
+template <typename T>
+size_t RadixDirectory<T>::getMemoryUsage() const {
+    size_t bytes = bucketCount * bucketBytes();
+    for (uint8_t level = 0; level < RADIX_LEVELS; level++) {
+        bytes += nodesPerLevel[level] * nodeBytes();
+    }
+    return bytes;
+}
+
+template <typename T>
+size_t RadixDirectory<T>::bucketBytes() {
+    return sizeof(Bucket<T>) + 2 * sizeof(long); // shared_ptr control block counters
+}
+
+template <typename T>
+size_t RadixDirectory<T>::nodeBytes() {
+    return sizeof(Node);
+}
+
+/**
+ * @brief Estimates the extra memory needed to split the bucket at the end of a path.
+ *
+ * Splitting inside a node adds one bucket; a bucket that owns a single slot also
+ * needs a new child node.
+ *
+ * @tparam T The type parameter for the RadixDirectory class.
+ * @param path The path to the full bucket.
+ * @return The estimated number of extra bytes.
+ */
+template <typename T>
+size_t RadixDirectory<T>::growthCost(const Path& path) const {
+    const Node* node = path.steps[path.length - 1].first;
+    const uint32_t localDepth = path.slot().bucket->getLocalDepth();
+    if (localDepth < baseDepth(node->level) + bitsOf(node->level) || localDepth >= MAX_KEY_LENGTH) return bucketBytes();
+    return bucketBytes() + nodeBytes();
+}
+
+/**
+ * @brief Walks from the root to the slot holding the bucket responsible for a key.
+ *
+ * @tparam T The type parameter for the RadixDirectory class.
+ * @param key The key to locate.
+ * @return The path of nodes and slot indices, ending at a slot that holds a bucket.
+ */
+template <typename T>
+typename RadixDirectory<T>::Path RadixDirectory<T>::locate(const uint32_t key) const {
+    Path path;
+    Node* node = root.get();
+    while (true) {
+        const uint32_t index = slotIndex(key, node->level);
+        path.steps[path.length++] = { node, index };
+        if (!node->slots[index].child) return path;
+        node = node->slots[index].child.get();
+    }
+}
+
+/**
+ * @brief Walks from the root to the bucket responsible for a key, without recording the path.
+ *
+ * Used by the lookups, each level costs one load of the slot stored inline in the node.
+ *
+ * @tparam T The type parameter for the RadixDirectory class.
+ * @param key The key to locate.
+ * @return The bucket covering the key.
+ */
+template <typename T>
+Bucket<T>& RadixDirectory<T>::bucketOf(const uint32_t key) const {
+    const Node* node = root.get();
+    while (true) {
+        const Slot& slot = node->slots[slotIndex(key, node->level)];
+        if (!slot.child) return *slot.bucket;
+        node = slot.child.get();
+    }
+}
+
+template <typename T>
+void RadixDirectory<T>::display() const {
+    if (!root) return; // Not initialized
+
+    std::vector<const Bucket<T>*> buckets;
+    collectBuckets(*root, buckets);
+
+    std::cout << "Radix Directory\n";
+    std::cout << "Depth: " << (uint32_t)getGlobalDepth() << "\n";
+    std::cout << "Number of buckets: " << buckets.size() << ", nodes: " << getNodeCount() << "\n";
+    displayNode(*root, 0, 0);
+}
+
+/**
+ * @brief Prints the slots of a node, recursing into child nodes.
+ *
+ * Each slot is labelled with the key range it covers. Consecutive slots sharing a
+ * bucket are printed once, since a bucket always owns an aligned run of slots.
+ *
+ * @tparam T The type of elements stored in the buckets.
+ * @param node The node to print.
+ * @param firstKey The smallest key covered by the node.
+ * @param indent The number of spaces to indent the node by.
+ */
+template <typename T>
+void RadixDirectory<T>::displayNode(const Node& node, const uint32_t firstKey, const size_t indent) const {
+    const uint32_t width = slotWidth(node.level);
+    for (size_t i = 0; i < node.slotCount();) {
+        const Slot& slot = node.slots[i];
+        size_t last = i;
+        while (!slot.child && last + 1 < node.slotCount() && node.slots[last + 1].bucket == slot.bucket) {
+            last++;
+        }
+
+        const uint32_t lo = firstKey + i * width;
+        const uint32_t hi = firstKey + (last + 1) * width - 1;
+        std::cout << std::string(indent, ' ')
+                  << std::setw(12) << std::left << ("[" + std::to_string(lo) + ".." + std::to_string(hi) + "]");
+        if (slot.child) {
+            std::cout << "-> node\n";
+            displayNode(*slot.child, lo, indent + 2);
+        } else {
+            std::cout << std::setw(12) << std::left << ("(" + std::to_string(slot.bucket->getLocalDepth()) + ")") << " ";
+            slot.bucket->display();
+            std::cout << std::endl;
+        }
+        i = last + 1;
+    }
+}
+
+/**
+ * @brief Writes a copy of data to the radix directory using the specified key.
+ *
+ * The data is copied once and then moved into place, see the rvalue overload.
+ *
+ * @tparam T The type of data to be written.
+ * @param key The key used to determine the bucket.
+ * @param data The data to be written.
+ * @return true if the data was successfully written, false otherwise.
+ */
+template <typename T>
+bool RadixDirectory<T>::write(const uint32_t key, const T& data) {
+    return write(key, T(data));
+}
+
+/**
+ * @brief Moves data into the radix directory using the specified key.
+ *
+ * The bucket responsible for the key is located and written to. While it is full,
+ * it is split, which may hang a new node under its slot when the bucket already
+ * uses all the key bits of its node. Only the subtree of that key deepens.
+ * In cache mode, when growing would exceed the memory budget, an item of the
+ * target bucket is evicted with the CLOCK policy instead.
+ * A full bucket leaves data untouched, so every retry still sees the value.
+ * Keys wider than MAX_KEY_LENGTH bits are rejected, since slotIndex() would drop their high bits.
+ *
+ * @tparam T The type of data to be written.
+ * @param key The key used to determine the bucket.
+ * @param data The data to be moved into the directory.
+ * @return true if the data was successfully written, false otherwise.
+ */
+template <typename T>
+bool RadixDirectory<T>::write(const uint32_t key, T&& data) {
+    if (!root || key > MAX_KEY_VALUE) return false; // Not initialized or key out of range
+
+    Path path = locate(key);
+    while (!path.slot().bucket->write(key, std::move(data))) {
+        if (memoryBudget != 0 && getMemoryUsage() + growthCost(path) > memoryBudget) {
+            // Cache mode: make room in the target bucket instead of growing
+            if (!path.slot().bucket->evict()) return false;
+            evictions++;
+            return path.slot().bucket->write(key, std::move(data));
+        }
+        if (!splitOn(path)) return false;
+        path = locate(key);
+    }
+    return true;
+}
+
+/**
+ * @brief Replaces the value of an existing key with a copy of data.
+ *
+ * @tparam T The type of data to be written.
+ * @param key The key of the entry to update.
+ * @param data The new value.
+ * @return true if the key was found and updated, false otherwise.
+ */
+template <typename T>
+bool RadixDirectory<T>::update(const uint32_t key, const T& data) {
+    return update(key, T(data));
+}
+
+/**
+ * @brief Replaces the value of an existing key in place, without reshaping the trie.
+ *
+ * @tparam T The type of data to be written.
+ * @param key The key of the entry to update.
+ * @param data The new value, only moved from if the key was found.
+ * @return true if the key was found and updated, false otherwise.
+ */
+template <typename T>
+bool RadixDirectory<T>::update(const uint32_t key, T&& data) {
+    if (!root) return false; // Not initialized
+
+    return bucketOf(key).update(key, std::move(data));
+}
+
+/**
+ * @brief Erases an entry from the radix directory based on the provided key.
+ *
+ * After a successful erase, the bucket is repeatedly merged with its buddy and
+ * nodes reduced to a single bucket are folded back into their parent slot.
+ *
+ * @tparam T The type of the elements stored in the radix directory.
+ * @param key The key of the entry to be erased.
+ * @return true if the entry was successfully erased, false otherwise.
+ */
+template <typename T>
+bool RadixDirectory<T>::erase(const uint32_t key) {
+    if (!root) return false; // Not initialized
+
+    Path path = locate(key);
+    if (!path.slot().bucket->erase(key)) return false;
+
+    while (mergeOn(path)) {
+        path = locate(key);
+    }
+    return true;
+}
+
+/**
+ * @brief Finds an entry in the RadixDirectory using the provided key.
+ *
+ * @tparam T The type of the entry stored in the RadixDirectory.
+ * @param key The key used to locate the entry.
+ * @return std::optional<T> An optional containing the entry if found, or std::nullopt if not found.
+ */
+template <typename T>
+std::optional<T> RadixDirectory<T>::find(const uint32_t key) const {
+    if (!root) return std::nullopt; // Not initialized
+
+    return bucketOf(key).find(key);
+}
+
+/**
+ * @brief Returns a pointer to the data stored under a key, without copying it.
+ *
+ * Unlike find, the CLOCK reference bit of the entry is left untouched.
+ *
+ * @tparam T The type of the entry stored in the RadixDirectory.
+ * @param key The key used to locate the entry.
+ * @return A pointer to the data, valid until the directory is next modified, or nullptr if not found.
+ */
+template <typename T>
+const T* RadixDirectory<T>::get(const uint32_t key) const {
+    if (!root) return nullptr; // Not initialized
+
+    return bucketOf(key).get(key);
+}
+
+/**
+ * @brief Visits every entry with a key in [lo, hi] in ascending key order.
+ *
+ * Nodes keep their slots in key order, so the trie is walked depth first,
+ * skipping slots outside [lo, hi] and consecutive slots sharing a bucket.
+ *
+ * @tparam T The type of the entries stored in the RadixDirectory.
+ * @param lo The smallest key to visit (inclusive).
+ * @param hi The largest key to visit (inclusive).
+ * @param callback Invoked with the key and data of every matching entry.
+ */
+template <typename T>
+void RadixDirectory<T>::scan(const uint32_t lo, const uint32_t hi, const std::function<void(uint32_t, const T&)>& callback) const {
+    if (!root || lo > hi || lo > MAX_KEY_VALUE) return;
+
+    scanNode(*root, 0, lo, hi, callback);
+}
+
+template <typename T>
+void RadixDirectory<T>::scanNode(const Node& node, const uint32_t firstKey, const uint32_t lo, const uint32_t hi,
+                                 const std::function<void(uint32_t, const T&)>& callback) const {
+    const uint32_t width = slotWidth(node.level);
+    const Bucket<T>* previous = nullptr;
+    for (size_t i = 0; i < node.slotCount(); i++) {
+        const uint32_t slotLo = firstKey + i * width;
+        const uint32_t slotHi = slotLo + width - 1;
+        if (slotHi < lo) continue;
+        if (slotLo > hi) return;
+
+        const Slot& slot = node.slots[i];
+        if (slot.child) {
+            scanNode(*slot.child, slotLo, lo, hi, callback);
+            previous = nullptr;
+        } else if (slot.bucket.get() != previous) {
+            slot.bucket->scan(lo, hi, callback);
+            previous = slot.bucket.get();
+        }
+    }
+}
+
+/**
+ * @brief Appends every distinct bucket below a node in key order.
+ *
+ * @tparam T The type of elements stored in the buckets.
+ * @param node The node to collect from.
+ * @param buckets The list the buckets are appended to.
+ */
+template <typename T>
+void RadixDirectory<T>::collectBuckets(const Node& node, std::vector<const Bucket<T>*>& buckets) const {
+    const Bucket<T>* previous = nullptr;
+    for (size_t i = 0; i < node.slotCount(); i++) {
+        const Slot& slot = node.slots[i];
+        if (slot.child) {
+            collectBuckets(*slot.child, buckets);
+            previous = nullptr;
+        } else if (slot.bucket.get() != previous) {
+            buckets.push_back(slot.bucket.get());
+            previous = slot.bucket.get();
+        }
+    }
+}
+
+/**
+ * @brief Resolves the number of workers used by forEachBucket.
+ *
+ * A request of 0 threads means one worker per hardware thread. The result is
+ * never larger than the number of buckets and never smaller than one.
+ *
+ * @tparam T The type of the entries stored in the RadixDirectory.
+ * @param threads The requested number of workers.
+ * @return The number of workers that will be used.
+ */
+template <typename T>
+size_t RadixDirectory<T>::workerCount(const size_t threads) const {
+    return resolveWorkerCount(threads, bucketCount);
+}
+
+/**
+ * @brief Visits every distinct bucket exactly once using a pool of worker threads.
+ *
+ * The distinct buckets are first collected by a walk of the trie, then split into
+ * contiguous ranges, one per worker. The callback receives the worker index and
+ * must be safe to call concurrently. The directory must not be modified meanwhile.
+ *
+ * @tparam T The type of the entries stored in the RadixDirectory.
+ * @param callback Invoked with the worker index and each distinct bucket.
+ * @param threads The number of workers to use, 0 for one per hardware thread.
+ * @return The number of workers that were used.
+ */
+template <typename T>
+size_t RadixDirectory<T>::forEachBucket(const std::function<void(size_t, const Bucket<T>&)>& callback, size_t threads) const {
+    if (!root) return 0; // Not initialized
+
+    std::vector<const Bucket<T>*> buckets;
+    collectBuckets(*root, buckets);
+
+    const size_t workers = workerCount(threads);
+    auto visitRange = [&](size_t worker) {
+        const size_t first = buckets.size() * worker / workers;
+        const size_t last = buckets.size() * (worker + 1) / workers;
+        for (size_t i = first; i < last; i++) {
+            callback(worker, *buckets[i]);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (size_t worker = 1; worker < workers; worker++) {
+        pool.emplace_back(visitRange, worker);
+    }
+    visitRange(0);
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+    return workers;
+}
+
+template <typename T>
+void RadixDirectory<T>::forEach(const std::function<void(uint32_t, const T&)>& callback, size_t threads) const {
+    forEachBucket([&callback](size_t, const Bucket<T>& bucket) {
+        bucket.forEach(callback);
+    }, threads);
+}
+
+/**
+ * @brief Rehashes the items from the given old bucket into the radix directory.
+ *
+ * The old bucket is no longer in the trie, so its values are moved out of it.
+ *
+ * @tparam T The type of the items stored in the bucket.
+ * @param oldBucket A shared pointer to the bucket containing the items to be rehashed.
+ * @return true if all valid items are successfully rehashed, false otherwise.
+ */
+template <typename T>
+bool RadixDirectory<T>::reHashItems(const std::shared_ptr<Bucket<T>>& oldBucket) {
+    const auto& items = oldBucket->getItems();
+    for (size_t slot = 0; slot < items.size(); slot++) {
+        if (items[slot].isValid()) {
+            const uint32_t key = items[slot].getKey();
+            if (!write(key, oldBucket->take(slot))) return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Splits the bucket at the end of the given path into two buckets.
+ *
+ * A bucket of local depth d owns 2^(nodeDepth - d) aligned slots of its node, where
+ * nodeDepth is the number of key bits resolved once that node is consumed. If the
+ * bucket owns a single slot (d == nodeDepth), a child node whose slots all point to
+ * the bucket is created first, so that only this subtree grows. The slots are then
+ * halved between two new buckets of depth d + 1 and the old items are rehashed.
+ *
+ * @tparam T The type of the elements stored in the buckets.
+ * @param path The path to the slot holding the bucket to split.
+ * @return true if the bucket was split and its items rehashed, false otherwise.
+ */
+template <typename T>
+bool RadixDirectory<T>::splitOn(const Path& path) {
+    Node* node = path.steps[path.length - 1].first;
+    uint32_t index = path.steps[path.length - 1].second;
+    std::shared_ptr<Bucket<T>> oldBucket = node->slots[index].bucket;
+    const uint32_t localDepth = oldBucket->getLocalDepth();
+
+    if (localDepth == baseDepth(node->level) + bitsOf(node->level)) {
+        if (localDepth >= MAX_KEY_LENGTH) return false;
+
+        NodePtr child = makeNode(node->level + 1);
+        for (size_t i = 0; i < child->slotCount(); i++) {
+            child->slots[i].bucket = oldBucket;
+        }
+        nodesPerLevel[child->level]++;
+        node->slots[index].bucket.reset();
+        node->slots[index].child = std::move(child);
+        node = node->slots[index].child.get();
+        index = 0;
+    }
+
+    const uint32_t oldNumPtrs = 1 << (baseDepth(node->level) + bitsOf(node->level) - localDepth);
+    const uint32_t newNumPtrs = oldNumPtrs / 2;
+    const uint32_t start = index & ~(oldNumPtrs - 1);
+    std::shared_ptr<Bucket<T>> newBucket1 = Bucket<T>::make(localDepth + 1);
+    std::shared_ptr<Bucket<T>> newBucket2 = Bucket<T>::make(localDepth + 1);
+    for (size_t i = 0; i < newNumPtrs; i++) {
+        node->slots[start + i].bucket = newBucket1;
+        node->slots[start + i + newNumPtrs].bucket = newBucket2;
+    }
+    bucketCount++;
+
+    return reHashItems(oldBucket);
+}
+
+/**
+ * @brief Merges the bucket at the end of the given path with its buddy if possible.
+ *
+ * If the bucket owns every slot of a non-root node, the node is folded back into
+ * its parent slot instead. Otherwise the buddy run of slots must hold a bucket of
+ * the same local depth (not a child node), and the combined entry count must fit
+ * in one bucket. The root always keeps at least two buckets, as GlobalDirectory does.
+ *
+ * @tparam T The type of the elements stored in the buckets.
+ * @param path The path to the slot holding the bucket to merge.
+ * @return true if a merge or fold was performed, false otherwise.
+ */
+template <typename T>
+bool RadixDirectory<T>::mergeOn(const Path& path) {
+    Node* node = path.steps[path.length - 1].first;
+    const uint32_t index = path.steps[path.length - 1].second;
+    std::shared_ptr<Bucket<T>> deleteBucket = node->slots[index].bucket;
+    const uint32_t localDepth = deleteBucket->getLocalDepth();
+
+    if (localDepth == baseDepth(node->level)) {
+        if (path.length == 1) return false;
+
+        Slot& parentSlot = path.steps[path.length - 2].first->slots[path.steps[path.length - 2].second];
+        nodesPerLevel[node->level]--;
+        parentSlot.bucket = deleteBucket;
+        parentSlot.child.reset();
+        return true;
+    }
+    if (localDepth <= 1) return false;
+
+    const uint32_t numPtrs = 1 << (baseDepth(node->level) + bitsOf(node->level) - localDepth);
+    const uint32_t deleteIndex = index & ~(numPtrs - 1);
+    const uint32_t buddyIndex = deleteIndex ^ numPtrs;
+    const Slot& buddySlot = node->slots[buddyIndex];
+    if (buddySlot.child) return false;
+
+    std::shared_ptr<Bucket<T>> buddyBucket = buddySlot.bucket;
+    if (buddyBucket->getLocalDepth() != localDepth ||
+        deleteBucket->getEntryCount() + buddyBucket->getEntryCount() > BUCKET_CAPACITY) return false;
+
+    const uint32_t minIndex = std::min(deleteIndex, buddyIndex);
+    std::shared_ptr<Bucket<T>> mergedBucket = Bucket<T>::make(localDepth - 1);
+    for (size_t i = minIndex; i < minIndex + numPtrs * 2; i++) {
+        node->slots[i].bucket = mergedBucket;
+    }
+    bucketCount--;
+
+    return reHashItems(deleteBucket) && reHashItems(buddyBucket);
+}
+
+template class RadixDirectory<int>;
+template class RadixDirectory<CountedValue>;
@@ -0,0 +1,152 @@
+#pragma once
+#include <optional>
+#include <vector>
+#include <memory>
+#include <array>
+#include <functional>
+
+#include "Common.hpp"
+#include "ParallelReduce.hpp"
+#include "HugePageAllocator.hpp"
+
+template<typename T>
+class Bucket;
+
+/**
+ * @class RadixDirectory
+ * @brief A memory-compact alternative to GlobalDirectory for skewed key distributions.
+ *
+ * Instead of one flat array of 2^globalDepth slots, the directory is a radix trie whose
+ * nodes each consume RADIX_STRIDE key bits (most significant first). A bucket that must
+ * split past the bits of its node only deepens its own subtree by hanging a child node
+ * under its slot, so directory memory grows with the number of buckets rather than with
+ * 2^depth, and a lookup touches at most RADIX_LEVELS nodes before reaching the bucket.
+ *
+ * @tparam T The type of the data stored in the buckets.
+ */
+template<typename T>
+class RadixDirectory {
+public:
+    // Singleton pattern
+    static RadixDirectory& getInstance() {
+        static RadixDirectory instance;
+        return instance;
+    }
+
+    // Called when required to create directory
+    bool initialize(const std::shared_ptr<Bucket<T>>& initialFile);
+
+    [[nodiscard]] bool write(const uint32_t key, const T& data);
+    [[nodiscard]] bool write(const uint32_t key, T&& data);
+    // Replaces the value of an existing key in place, false if the key is absent
+    [[nodiscard]] bool update(const uint32_t key, const T& data);
+    [[nodiscard]] bool update(const uint32_t key, T&& data);
+    [[nodiscard]] bool erase(const uint32_t key);
+
+    void display() const;
+    [[nodiscard]] std::optional<T> find(const uint32_t key) const;
+    [[nodiscard]] const T* get(const uint32_t key) const;
+
+    // Calls visitor with the data of the key in place
+    template <typename Visitor>
+    bool visit(const uint32_t key, Visitor&& visitor) const {
+        if (!root) return false; // Not initialized
+        return bucketOf(key).visit(key, visitor);
+    }
+    void scan(const uint32_t lo, const uint32_t hi, const std::function<void(uint32_t, const T&)>& callback) const;
+
+    size_t forEachBucket(const std::function<void(size_t, const Bucket<T>&)>& callback, size_t threads = 0) const;
+    void forEach(const std::function<void(uint32_t, const T&)>& callback, size_t threads = 0) const;
+
+    // Folds map(key, data) over every entry with combine, one partial result per worker.
+    // combine must be associative and commutative as workers finish in any order.
+    template <typename R, typename Map, typename Combine>
+    R reduce(R identity, Map map, Combine combine, size_t threads = 0) const {
+        return reduceBuckets(*this, std::move(identity), map, combine, threads);
+    }
+    // Workers forEachBucket runs for a requested thread count, 0 for one per hardware thread
+    size_t workerCount(const size_t threads) const;
+
+    // Number of key bits covered by the deepest node, 0 when not initialized
+    uint8_t getGlobalDepth() const;
+    size_t getNodeCount() const;
+
+    // Cache mode: once the budget is reached, full buckets evict instead of growing (0 disables)
+    void setMemoryBudget(const size_t bytes) { memoryBudget = bytes; }
+    size_t getMemoryBudget() const { return memoryBudget; }
+    size_t getMemoryUsage() const;
+    size_t getEvictionCount() const { return evictions; }
+
+    // Deleted copy constructor and assignment operator
+    RadixDirectory(const RadixDirectory&) = delete;
+    RadixDirectory& operator=(const RadixDirectory&) = delete;
+
+private:
+    struct Node;
+
+    // Nodes follow the page mode configured on HugePageArena, like the buckets
+    struct NodeDeleter {
+        void operator()(Node* node) const {
+            node->~Node();
+            HugePageAllocator<Node>().deallocate(node, 1);
+        }
+    };
+    using NodePtr = std::unique_ptr<Node, NodeDeleter>;
+
+    // A slot holds either a bucket or a child node covering the next key bits
+    struct Slot {
+        std::shared_ptr<Bucket<T>> bucket;
+        NodePtr child;
+    };
+
+    // Slots are stored inline so that each level costs a single dependent load;
+    // a node of the last level may use only the first slotCount() of them
+    struct Node {
+        explicit Node(const uint8_t level) : level(level) {}
+
+        size_t slotCount() const { return (size_t)1 << bitsOf(level); }
+
+        uint8_t level;
+        std::array<Slot, (size_t)1 << RADIX_STRIDE> slots;
+    };
+
+    // Nodes and slot indices visited from the root down to a bucket slot
+    struct Path {
+        std::array<std::pair<Node*, uint32_t>, RADIX_LEVELS> steps;
+        size_t length{ 0 };
+
+        Slot& slot() const { return steps[length - 1].first->slots[steps[length - 1].second]; }
+    };
+
+    // Private constructor
+    RadixDirectory() = default;
+
+    // Utility functions
+    [[nodiscard]] bool reHashItems(const std::shared_ptr<Bucket<T>>& oldBucket);
+
+    [[nodiscard]] bool mergeOn(const Path& path);
+    [[nodiscard]] bool splitOn(const Path& path);
+
+    static NodePtr makeNode(const uint8_t level);
+    Path locate(const uint32_t key) const;
+    Bucket<T>& bucketOf(const uint32_t key) const;
+    void displayNode(const Node& node, const uint32_t firstKey, const size_t indent) const;
+    void scanNode(const Node& node, const uint32_t firstKey, const uint32_t lo, const uint32_t hi,
+                  const std::function<void(uint32_t, const T&)>& callback) const;
+    void collectBuckets(const Node& node, std::vector<const Bucket<T>*>& buckets) const;
+    size_t growthCost(const Path& path) const;
+    static size_t bucketBytes();
+    static size_t nodeBytes();
+
+    static uint32_t baseDepth(const uint8_t level) { return level * RADIX_STRIDE; }
+    static uint32_t bitsOf(const uint8_t level);
+    static uint32_t slotIndex(const uint32_t key, const uint8_t level);
+    static uint32_t slotWidth(const uint8_t level) { return 1 << (MAX_KEY_LENGTH - baseDepth(level) - bitsOf(level)); }
+
+    NodePtr root;
+    std::array<size_t, RADIX_LEVELS> nodesPerLevel{};
+
+    size_t bucketCount{ 0 };
+    size_t memoryBudget{ 0 };
+    size_t evictions{ 0 };
+};
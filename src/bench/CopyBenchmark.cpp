@@ -0,0 +1,91 @@
+// Copies and moves per operation of a heap-backed value, checking the copy-free paths.
+// Built by `make bench` with the benchmark key space, so splits and merges move entries too.
+//
+// Usage: Copy
+//
+// Each phase runs over its own keys and reports copies and moves per operation.
+// Phases with an expected copy count fail the run when it is not met.
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../MemoryManager.hpp"
+#include "../CountedValue.hpp"
+
+#define DATA_TYPE CountedValue
+
+static const size_t KEY_COUNT = (size_t)1 << 16;
+static const size_t ANY_COPIES = (size_t)-1;
+
+// Runs one phase over keys and prints its cost, returning false if the copy count is unexpected
+static bool phase(const char* name, const std::vector<uint32_t>& keys, const size_t expectedCopies,
+                  const std::function<void(uint32_t)>& operation) {
+    const size_t copies = CountedValue::getCopies();
+    const size_t moves = CountedValue::getMoves();
+    const auto begin = std::chrono::steady_clock::now();
+    for (uint32_t key : keys) {
+        operation(key);
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    const size_t phaseCopies = CountedValue::getCopies() - copies;
+    const bool ok = expectedCopies == ANY_COPIES || phaseCopies == expectedCopies;
+    std::cout << "  " << name << ": ns/op=" << std::chrono::duration<double, std::nano>(end - begin).count() / keys.size()
+              << " copies/op=" << (double)phaseCopies / keys.size()
+              << " moves/op=" << (double)(CountedValue::getMoves() - moves) / keys.size()
+              << (ok ? "" : "  UNEXPECTED COPIES") << std::endl;
+    return ok;
+}
+
+int main() {
+    MemoryManager<DATA_TYPE>& manager = MemoryManager<DATA_TYPE>::getInstance();
+
+    std::mt19937 rng(42);
+    std::vector<uint32_t> keys(MAX_KEY_VALUE + 1);
+    for (uint32_t i = 0; i < keys.size(); i++) keys[i] = i;
+    std::shuffle(keys.begin(), keys.end(), rng);
+    keys.resize(std::min(2 * KEY_COUNT, keys.size()));
+    const std::vector<uint32_t> moved(keys.begin(), keys.begin() + keys.size() / 2);
+    const std::vector<uint32_t> copied(keys.begin() + keys.size() / 2, keys.end());
+
+    size_t failures = 0;
+    std::cout << "keys=" << keys.size() << " payload copies allocate\n";
+    // Splits triggered by these writes move the entries already in place
+    failures += !phase("write(T&&)", moved, 0, [&](uint32_t key) {
+        if (!manager.write(key, CountedValue((int)key))) failures++;
+    });
+    failures += !phase("write(const T&)", copied, copied.size(), [&](uint32_t key) {
+        const CountedValue value((int)key);
+        if (!manager.write(key, value)) failures++;
+    });
+    failures += !phase("visit", keys, 0, [&](uint32_t key) {
+        if (!manager.visit(key, [key](const CountedValue& value) { (void)(value.getValue() == (int)key); })) failures++;
+    });
+    failures += !phase("get", keys, 0, [&](uint32_t key) {
+        if (!manager.get(key)) failures++;
+    });
+    failures += !phase("find", keys, keys.size(), [&](uint32_t key) {
+        if (!manager.find(key)) failures++;
+    });
+    failures += !phase("update(T&&)", keys, 0, [&](uint32_t key) {
+        if (!manager.update(key, CountedValue((int)key + 1))) failures++;
+    });
+    // Merges move the surviving entries too
+    failures += !phase("erase", copied, 0, [&](uint32_t key) {
+        if (!manager.erase(key)) failures++;
+    });
+#ifndef COMPACT_DIRECTORY
+    // Buckets shared with a snapshot are copied before their first modification
+    const auto snapshot = manager.snapshot();
+    failures += !phase("write(T&&) behind a snapshot", copied, ANY_COPIES, [&](uint32_t key) {
+        if (!manager.write(key, CountedValue((int)key))) failures++;
+    });
+#endif
+
+    std::cout << (failures == 0 ? "ok" : "FAILED") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
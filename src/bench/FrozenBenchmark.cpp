@@ -0,0 +1,85 @@
+// Lookup latency and memory of the mutable table versus its frozen copy.
+// Built by `make bench` on the same key space as the lookup benchmark.
+//
+// Usage: Frozen [threads]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../MemoryManager.hpp"
+#include "../FrozenTable.hpp"
+
+#define DATA_TYPE int
+
+static const size_t KEY_COUNT = (size_t)1 << 20;
+static const size_t LOOKUP_COUNT = (size_t)1 << 23;
+
+// Mean nanoseconds per lookup over the whole lookup sequence
+static double timeLookups(const std::vector<uint32_t>& lookups, const std::function<bool(uint32_t)>& lookup, size_t& found) {
+    auto begin = std::chrono::steady_clock::now();
+    for (uint32_t key : lookups) {
+        found += lookup(key);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - begin).count() / lookups.size();
+}
+
+int main(int argc, char** argv) {
+    const size_t threads = argc > 1 ? std::max(1, std::atoi(argv[1])) : std::max(1u, std::thread::hardware_concurrency());
+
+    MemoryManager<DATA_TYPE>& manager = MemoryManager<DATA_TYPE>::getInstance();
+    GlobalDirectory<DATA_TYPE>& directory = GlobalDirectory<DATA_TYPE>::getInstance();
+
+    std::mt19937 rng(42);
+    std::vector<uint32_t> keys(MAX_KEY_VALUE + 1);
+    for (uint32_t i = 0; i < keys.size(); i++) keys[i] = i;
+    std::shuffle(keys.begin(), keys.end(), rng);
+    keys.resize(std::min(KEY_COUNT, keys.size()));
+    for (uint32_t key : keys) {
+        (void)manager.write(key, (DATA_TYPE)key);
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    const FrozenTable<DATA_TYPE> frozen = manager.freeze();
+    const double freezeMillis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    std::vector<uint32_t> lookups(LOOKUP_COUNT);
+    std::uniform_int_distribution<size_t> pick(0, keys.size() - 1);
+    for (uint32_t& key : lookups) key = keys[pick(rng)];
+
+    size_t found = 0;
+    const double mutableNanos = timeLookups(lookups, [&](uint32_t key) { return directory.find(key).has_value(); }, found);
+    const double frozenNanos = timeLookups(lookups, [&](uint32_t key) { return frozen.get(key) != nullptr; }, found);
+
+    // Concurrent readers share the frozen table without any synchronisation
+    std::atomic<size_t> sharedFound{ 0 };
+    std::vector<std::thread> readers;
+    begin = std::chrono::steady_clock::now();
+    for (size_t worker = 0; worker < threads; worker++) {
+        readers.emplace_back([&, worker]() {
+            size_t local = 0;
+            for (size_t i = worker; i < lookups.size(); i += threads) {
+                local += frozen.get(lookups[i]) != nullptr;
+            }
+            sharedFound += local;
+        });
+    }
+    for (std::thread& reader : readers) reader.join();
+    const double sharedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::cout << "keys=" << frozen.size() << " globalDepth=" << (uint32_t)directory.getGlobalDepth()
+              << " frozenDepth=" << (uint32_t)frozen.getDepth()
+              << " found=" << found + sharedFound << "/" << 3 * lookups.size() << "\n"
+              << "  mutable: lookup ns=" << mutableNanos << " MiB=" << (manager.getMemoryUsage() >> 20) << "\n"
+              << "  frozen:  lookup ns=" << frozenNanos << " MiB=" << (frozen.getMemoryUsage() >> 20)
+              << " freeze ms=" << freezeMillis << "\n"
+              << "  frozen, " << threads << " threads: " << (size_t)(lookups.size() / sharedSeconds) << " lookups/s" << std::endl;
+    return 0;
+}
@@ -0,0 +1,61 @@
+// Load factor benchmark for the insertion modes of GlobalDirectory.
+// Built by `make bench` with the same wide key space as the lookup benchmark.
+//
+// Usage: LoadFactor [single|balanced]
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../MemoryManager.hpp"
+
+#define DATA_TYPE int
+
+static const size_t KEY_COUNT = (size_t)1 << 20;
+static const size_t LOOKUP_COUNT = (size_t)1 << 22;
+
+int main(int argc, char** argv) {
+    const bool balanced = argc > 1 && std::strcmp(argv[1], "balanced") == 0;
+
+    MemoryManager<DATA_TYPE>& manager = MemoryManager<DATA_TYPE>::getInstance();
+    GlobalDirectory<DATA_TYPE>& directory = GlobalDirectory<DATA_TYPE>::getInstance();
+    // Must happen before the first write overflows the initial file
+    directory.setInsertionMode(balanced ? InsertionMode::BALANCED : InsertionMode::SINGLE);
+
+    std::mt19937 rng(42);
+    std::vector<uint32_t> keys(MAX_KEY_VALUE + 1);
+    for (uint32_t i = 0; i < keys.size(); i++) keys[i] = i;
+    std::shuffle(keys.begin(), keys.end(), rng);
+    keys.resize(std::min(KEY_COUNT, keys.size()));
+
+    size_t failedWrites = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for (uint32_t key : keys) {
+        if (!manager.write(key, (DATA_TYPE)key)) failedWrites++;
+    }
+    auto end = std::chrono::steady_clock::now();
+    const double insertNanos = std::chrono::duration<double, std::nano>(end - begin).count() / keys.size();
+
+    std::uniform_int_distribution<size_t> pick(0, keys.size() - 1);
+    std::vector<uint32_t> lookups(LOOKUP_COUNT);
+    for (uint32_t& key : lookups) key = keys[pick(rng)];
+    size_t found = 0;
+    begin = std::chrono::steady_clock::now();
+    for (uint32_t key : lookups) {
+        found += directory.find(key).has_value();
+    }
+    end = std::chrono::steady_clock::now();
+    const double lookupNanos = std::chrono::duration<double, std::nano>(end - begin).count() / lookups.size();
+
+    std::cout << "mode=" << (balanced ? "balanced" : "single")
+              << " keys=" << keys.size() - failedWrites << " failedWrites=" << failedWrites
+              << " found=" << found << "/" << lookups.size() << "\n"
+              << "  loadFactor=" << directory.getLoadFactor()
+              << " globalDepth=" << (uint32_t)directory.getGlobalDepth()
+              << " memory MiB=" << (directory.getMemoryUsage() >> 20) << "\n"
+              << "  insert ns=" << insertNanos << " lookup ns=" << lookupNanos << std::endl;
+    return 0;
+}
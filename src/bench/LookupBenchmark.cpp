@@ -0,0 +1,83 @@
+// Lookup latency benchmark for the page modes of HugePageArena.
+// Built by `make bench` with a wider key space than the demo so the directory and
+// buckets span far more memory than the TLB covers.
+//
+// Usage: Lookup [default|transparent|explicit] [none|interleave|bind] [node]
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../MemoryManager.hpp"
+#include "../HugePageAllocator.hpp"
+
+#define DATA_TYPE int
+
+static const size_t KEY_COUNT = (size_t)1 << 20;
+static const size_t LOOKUP_COUNT = (size_t)1 << 23;
+static const size_t BATCH_SIZE = 4096;
+
+int main(int argc, char** argv) {
+    PageMode mode = PageMode::DEFAULT;
+    NumaPolicy policy = NumaPolicy::NONE;
+    if (argc > 1 && std::strcmp(argv[1], "transparent") == 0) mode = PageMode::TRANSPARENT;
+    if (argc > 1 && std::strcmp(argv[1], "explicit") == 0) mode = PageMode::EXPLICIT;
+    if (argc > 2 && std::strcmp(argv[2], "interleave") == 0) policy = NumaPolicy::INTERLEAVE;
+    if (argc > 2 && std::strcmp(argv[2], "bind") == 0) policy = NumaPolicy::BIND;
+    const int node = argc > 3 ? std::atoi(argv[3]) : 0;
+
+    // Must happen before the first bucket is allocated
+    HugePageArena::getInstance().configure(mode, policy, node);
+
+    MemoryManager<DATA_TYPE>& manager = MemoryManager<DATA_TYPE>::getInstance();
+    GlobalDirectory<DATA_TYPE>& directory = GlobalDirectory<DATA_TYPE>::getInstance();
+
+    std::mt19937 rng(42);
+    std::vector<uint32_t> keys(MAX_KEY_VALUE + 1);
+    for (uint32_t i = 0; i < keys.size(); i++) keys[i] = i;
+    std::shuffle(keys.begin(), keys.end(), rng);
+    keys.resize(std::min(KEY_COUNT, keys.size()));
+
+    size_t failedWrites = 0;
+    for (uint32_t key : keys) {
+        if (!manager.write(key, (DATA_TYPE)key)) failedWrites++;
+    }
+
+    std::vector<uint32_t> lookups(LOOKUP_COUNT);
+    std::uniform_int_distribution<size_t> pick(0, keys.size() - 1);
+    for (uint32_t& key : lookups) key = keys[pick(rng)];
+
+    // Time batches rather than single lookups to keep clock overhead out of the numbers
+    std::vector<double> batchNanos;
+    size_t found = 0;
+    for (size_t start = 0; start < lookups.size(); start += BATCH_SIZE) {
+        auto begin = std::chrono::steady_clock::now();
+        for (size_t i = start; i < start + BATCH_SIZE; i++) {
+            found += directory.find(lookups[i]).has_value();
+        }
+        auto end = std::chrono::steady_clock::now();
+        batchNanos.push_back(std::chrono::duration<double, std::nano>(end - begin).count() / BATCH_SIZE);
+    }
+    std::sort(batchNanos.begin(), batchNanos.end());
+    double mean = 0;
+    for (double nanos : batchNanos) mean += nanos;
+    mean /= batchNanos.size();
+
+    const HugePageArena::Stats stats = HugePageArena::getInstance().getStats();
+    const char* modeNames[] = { "default", "transparent", "explicit" };
+    std::cout << "mode=" << modeNames[(int)mode]
+              << " keys=" << keys.size() - failedWrites << " failedWrites=" << failedWrites
+              << " globalDepth=" << (uint32_t)directory.getGlobalDepth()
+              << " found=" << found << "/" << lookups.size() << "\n"
+              << "  lookup ns: mean=" << mean
+              << " p50=" << batchNanos[batchNanos.size() / 2]
+              << " p99=" << batchNanos[batchNanos.size() * 99 / 100] << "\n"
+              << "  hugetlb MiB=" << (stats.hugeTlbBytes >> 20)
+              << " thp MiB=" << (stats.transparentBytes >> 20)
+              << " numa MiB=" << (stats.numaBoundBytes >> 20)
+              << " fallbacks=" << stats.fallbacks << std::endl;
+    return 0;
+}
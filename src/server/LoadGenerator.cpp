@@ -0,0 +1,243 @@
+// Load generator for the server, reporting throughput and round trip latency.
+// Built by `make server`, Linux only.
+//
+// Usage: loadgen [--port N | --unix PATH] [--connections N] [--pipeline N]
+//                [--requests N] [--keys N] [--reads PERCENT]
+//
+// Each connection runs on its own thread, preloads its share of the keys with SET,
+// then repeatedly sends a pipeline of GET/SET requests and waits for all replies.
+// Throughput is timed from the moment every connection finished its preload, so only
+// the measured requests fall inside the window. Failed preload SETs count as errors.
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../Common.hpp"
+
+struct Options {
+    int port{ 6380 };
+    std::string unixPath;
+    size_t connections{ 4 };
+    size_t pipeline{ 32 };
+    size_t requests{ 200000 };
+    size_t keys{ 100000 };
+    size_t readPercent{ 90 };
+};
+
+// Holds the connections after their preload until main() starts the clock
+class StartGate {
+public:
+    explicit StartGate(const size_t count) : count(count) {}
+
+    // Called by each connection, blocks until open() is called
+    void arrive() {
+        std::unique_lock<std::mutex> lock(mutex);
+        arrived++;
+        changed.notify_all();
+        changed.wait(lock, [this] { return opened; });
+    }
+
+    // Waits for every connection to arrive, then releases them all
+    void open() {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this] { return arrived == count; });
+        opened = true;
+        changed.notify_all();
+    }
+
+private:
+    const size_t count;
+    size_t arrived{ 0 };
+    bool opened{ false };
+    std::mutex mutex;
+    std::condition_variable changed;
+};
+
+struct Result {
+    size_t requests{ 0 };
+    size_t errors{ 0 };
+    std::vector<double> roundTripMicros;
+};
+
+static int connectTo(const Options& options) {
+    if (!options.unixPath.empty()) {
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, options.unixPath.c_str(), sizeof(address.sun_path) - 1);
+        if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) return fd;
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(options.port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+        const int enable = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        return fd;
+    }
+    if (fd >= 0) close(fd);
+    return -1;
+}
+
+/**
+ * @brief Sends a pipeline of requests and reads back one reply line per request.
+ *
+ * @return The number of error replies, or -1 if the connection failed.
+ */
+static long roundTrip(const int fd, const std::string& requests, const size_t count, std::string& buffer) {
+    size_t sent = 0;
+    while (sent < requests.size()) {
+        const ssize_t written = write(fd, requests.data() + sent, requests.size() - sent);
+        if (written <= 0) return -1;
+        sent += written;
+    }
+
+    size_t lines = 0;
+    long errors = 0;
+    buffer.clear();
+    char chunk[16 << 10];
+    size_t scanned = 0;
+    while (lines < count) {
+        const ssize_t received = read(fd, chunk, sizeof(chunk));
+        if (received <= 0) return -1;
+        buffer.append(chunk, received);
+        for (size_t end = buffer.find('\n', scanned); end != std::string::npos; end = buffer.find('\n', scanned)) {
+            errors += buffer[scanned] == '-';
+            lines++;
+            scanned = end + 1;
+        }
+    }
+    return errors;
+}
+
+static void runConnection(const Options& options, const size_t id, StartGate& gate, Result& result) {
+    const int fd = connectTo(options);
+    if (fd < 0) {
+        result.errors++;
+        gate.arrive();
+        return;
+    }
+
+    std::mt19937 rng(id + 1);
+    std::uniform_int_distribution<uint32_t> pickKey(0, (uint32_t)std::min<size_t>(options.keys, MAX_KEY_VALUE + 1) - 1);
+    std::uniform_int_distribution<size_t> pickPercent(0, 99);
+    std::string requests;
+    std::string buffer;
+
+    // Preload this connection's share of the key space
+    for (size_t key = id; key < options.keys && key <= MAX_KEY_VALUE; key += options.connections * options.pipeline) {
+        requests.clear();
+        size_t count = 0;
+        for (size_t k = key; count < options.pipeline && k < options.keys && k <= MAX_KEY_VALUE; k += options.connections, count++) {
+            requests += "SET " + std::to_string(k) + " " + std::to_string(k) + "\r\n";
+        }
+        const long errors = roundTrip(fd, requests, count, buffer);
+        if (errors < 0) {
+            result.errors++;
+            gate.arrive();
+            close(fd);
+            return;
+        }
+        result.errors += errors;
+    }
+    gate.arrive();
+
+    const size_t share = options.requests / options.connections;
+    while (result.requests < share) {
+        requests.clear();
+        const size_t count = std::min(options.pipeline, share - result.requests);
+        for (size_t i = 0; i < count; i++) {
+            const uint32_t key = pickKey(rng);
+            if (pickPercent(rng) < options.readPercent) {
+                requests += "GET " + std::to_string(key) + "\r\n";
+            } else {
+                requests += "SET " + std::to_string(key) + " " + std::to_string(rng() & 0xffff) + "\r\n";
+            }
+        }
+
+        const auto begin = std::chrono::steady_clock::now();
+        const long errors = roundTrip(fd, requests, count, buffer);
+        const auto end = std::chrono::steady_clock::now();
+        if (errors < 0) {
+            result.errors++;
+            break;
+        }
+        result.errors += errors;
+        result.requests += count;
+        result.roundTripMicros.push_back(std::chrono::duration<double, std::micro>(end - begin).count());
+    }
+    close(fd);
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string flag = argv[i];
+        const char* value = argv[i + 1];
+        if (flag == "--port") options.port = std::atoi(value);
+        if (flag == "--unix") options.unixPath = value;
+        if (flag == "--connections") options.connections = std::max(1, std::atoi(value));
+        if (flag == "--pipeline") options.pipeline = std::max(1, std::atoi(value));
+        if (flag == "--requests") options.requests = std::strtoull(value, nullptr, 10);
+        if (flag == "--keys") options.keys = std::max(1ULL, std::strtoull(value, nullptr, 10));
+        if (flag == "--reads") options.readPercent = std::min(100, std::atoi(value));
+    }
+
+    std::vector<Result> results(options.connections);
+    std::vector<std::thread> threads;
+    StartGate gate(options.connections);
+    for (size_t id = 0; id < options.connections; id++) {
+        threads.emplace_back(runConnection, std::cref(options), id, std::ref(gate), std::ref(results[id]));
+    }
+    gate.open();
+    const auto begin = std::chrono::steady_clock::now();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    size_t requests = 0;
+    size_t errors = 0;
+    std::vector<double> roundTrips;
+    for (const Result& result : results) {
+        requests += result.requests;
+        errors += result.errors;
+        roundTrips.insert(roundTrips.end(), result.roundTripMicros.begin(), result.roundTripMicros.end());
+    }
+    if (roundTrips.empty()) {
+        std::cerr << "Error: no request completed, is the server running?" << std::endl;
+        return 1;
+    }
+    std::sort(roundTrips.begin(), roundTrips.end());
+
+    std::cout << "transport=" << (options.unixPath.empty() ? "tcp" : "unix")
+              << " connections=" << options.connections << " pipeline=" << options.pipeline
+              << " reads=" << options.readPercent << "%\n"
+              << "  requests=" << requests << " errors=" << errors
+              << " throughput=" << (size_t)(requests / seconds) << " req/s\n"
+              << "  round trip us: p50=" << roundTrips[roundTrips.size() / 2]
+              << " p99=" << roundTrips[roundTrips.size() * 99 / 100]
+              << " max=" << roundTrips.back() << std::endl;
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,429 @@
+// Standalone server sharing one MemoryManager between processes.
+// Built by `make server`, Linux only (epoll).
+//
+// Usage: server [--port N] [--unix PATH]
+//
+// Protocol: RESP-like inline commands, one per line, answered in order with one line each.
+//   SET <key> <value>   -> +OK             | -ERR <reason>
+//   GET <key>           -> :<value>        | $-1 (not found)
+//   DEL <key>           -> :1 (erased)     | :0 (not found)
+//   PING                -> +PONG
+// Clients may pipeline any number of commands without waiting for replies. A line longer
+// than MAX_LINE is answered with -ERR and the connection is closed once replies are sent.
+
+#include <cctype>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../MemoryManager.hpp"
+
+#define DATA_TYPE int
+
+static const int DEFAULT_PORT = 6380;
+static const char* DEFAULT_UNIX_PATH = "/tmp/extendible-hashing.sock";
+static const size_t READ_CHUNK = 64 << 10;
+static const size_t READ_BUDGET = 4 * READ_CHUNK;      // bytes read per connection per loop iteration
+static const size_t MAX_LINE = 4 << 10;                // longest accepted request line
+static const size_t OUTPUT_HIGH_WATER = 1 << 20;       // stop reading while this many reply bytes are pending
+static const int MAX_EVENTS = 256;
+
+static volatile std::sig_atomic_t running = 1;
+
+static void stop(int) { running = 0; }
+
+/**
+ * @class Server
+ * @brief Single threaded epoll event loop serving one MemoryManager.
+ *
+ * Each loop iteration reads everything the ready connections sent, parses every
+ * complete line into a request, executes the whole batch against the table in one
+ * pass, and then flushes each connection's replies with a single write. Running
+ * the table on the event loop thread keeps MemoryManager free of locks.
+ * Memory per connection is bounded: each iteration reads at most READ_BUDGET bytes,
+ * a partial line may not exceed MAX_LINE, and a client that does not read its replies
+ * stops being read once OUTPUT_HIGH_WATER bytes are pending.
+ */
+class Server {
+public:
+    explicit Server(MemoryManager<DATA_TYPE>& manager) : manager(manager), spareFd(open("/dev/null", O_RDONLY | O_CLOEXEC)) {}
+
+    ~Server() {
+        for (auto& connection : connections) {
+            close(connection.first);
+        }
+        for (int fd : listeners) {
+            close(fd);
+        }
+        if (epollFd >= 0) close(epollFd);
+        if (spareFd >= 0) close(spareFd);
+        if (!unixPath.empty()) unlink(unixPath.c_str());
+    }
+
+    bool listenTcp(const int port);
+    bool listenUnix(const std::string& path);
+    int run();
+
+private:
+    enum class Operation { SET, GET, DEL, PING, INVALID, LINE_TOO_LONG };
+
+    struct Request {
+        int fd;
+        Operation operation;
+        uint32_t key;
+        DATA_TYPE value;
+    };
+
+    struct Connection {
+        std::string input;
+        std::string output;
+        bool closing{ false };      // close right away, the socket failed
+        bool draining{ false };     // no more requests, close once output is sent
+        uint32_t events{ EPOLLIN | EPOLLRDHUP };   // currently registered with epoll
+    };
+
+    bool addListener(const int fd);
+    void accept(const int listener);
+    void read(const int fd, Connection& connection);
+    void flush(const int fd, Connection& connection);
+    void watch(const int fd, Connection& connection);
+    void execute(const Request& request, std::string& reply);
+    static Request parse(const int fd, const std::string& line);
+
+    MemoryManager<DATA_TYPE>& manager;
+    int epollFd{ -1 };
+    int spareFd{ -1 };          // released to shed a pending connection when out of descriptors
+    std::vector<int> listeners;
+    std::string unixPath;
+    std::unordered_map<int, Connection> connections;
+    std::vector<Request> batch;
+};
+
+static bool setNonBlocking(const int fd) {
+    const int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+bool Server::addListener(const int fd) {
+    if (epollFd < 0) epollFd = epoll_create1(0);
+    if (epollFd < 0 || !setNonBlocking(fd) || listen(fd, SOMAXCONN) != 0) return false;
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) return false;
+    listeners.push_back(fd);
+    return true;
+}
+
+bool Server::listenTcp(const int port) {
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+
+    const int enable = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || !addListener(fd)) {
+        close(fd);
+        return false;
+    }
+    return true;
+}
+
+bool Server::listenUnix(const std::string& path) {
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || path.size() >= sizeof(sockaddr_un::sun_path)) {
+        if (fd >= 0) close(fd);
+        return false;
+    }
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    unlink(path.c_str());
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || !addListener(fd)) {
+        close(fd);
+        return false;
+    }
+    unixPath = path;
+    return true;
+}
+
+/**
+ * @brief Accepts every pending connection of a listener.
+ *
+ * When the process or the system runs out of descriptors, a pending connection stays
+ * in the backlog and the level triggered listener would wake the loop forever. The
+ * spare descriptor is then released to accept that connection and close it right away,
+ * so the client sees a reset instead of hanging, and is reserved again afterwards.
+ */
+void Server::accept(const int listener) {
+    while (true) {
+        const int fd = ::accept(listener, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            if ((errno == EMFILE || errno == ENFILE) && spareFd >= 0) {
+                close(spareFd);
+                const int dropped = ::accept(listener, nullptr, nullptr);
+                if (dropped >= 0) close(dropped);
+                spareFd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+                if (dropped >= 0) {
+                    std::cerr << "Warning: out of file descriptors, dropped a connection" << std::endl;
+                    continue;
+                }
+            }
+            return; // EAGAIN once the backlog is drained
+        }
+
+        const int enable = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable)); // fails harmlessly on unix sockets
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.fd = fd;
+        if (!setNonBlocking(fd) || epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close(fd);
+            continue;
+        }
+        connections[fd];
+    }
+}
+
+/**
+ * @brief Reads up to READ_BUDGET bytes from a connection and queues every complete line as a request.
+ *
+ * A trailing partial line stays in the input buffer until the rest arrives, unless it
+ * grows past MAX_LINE: it is then answered with an error and the connection stops reading.
+ * Whatever is left unread is picked up on the next iteration, as epoll is level triggered.
+ * When the peer shuts down its side, the connection drains its pending replies first.
+ */
+void Server::read(const int fd, Connection& connection) {
+    char buffer[READ_CHUNK];
+    size_t total = 0;
+    while (total < READ_BUDGET) {
+        const ssize_t count = ::read(fd, buffer, sizeof(buffer));
+        if (count > 0) {
+            connection.input.append(buffer, count);
+            total += count;
+            continue;
+        }
+        if (count < 0 && errno == EINTR) continue;
+        if (count == 0) {
+            connection.draining = true;
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            connection.closing = true;
+        }
+        break;
+    }
+
+    size_t start = 0;
+    bool tooLong = false;
+    for (size_t end = connection.input.find('\n'); end != std::string::npos; end = connection.input.find('\n', start)) {
+        size_t length = end - start;
+        if (length > 0 && connection.input[end - 1] == '\r') length--;
+        if (length > MAX_LINE) {
+            tooLong = true;
+            break;
+        }
+        if (length > 0) {
+            batch.push_back(parse(fd, connection.input.substr(start, length)));
+        }
+        start = end + 1;
+    }
+    if (tooLong || connection.input.size() - start > MAX_LINE) {
+        batch.push_back(Request{ fd, Operation::LINE_TOO_LONG, 0, 0 });
+        connection.input.clear();
+        connection.draining = true;
+        return;
+    }
+    connection.input.erase(0, start);
+}
+
+Server::Request Server::parse(const int fd, const std::string& line) {
+    Request request{ fd, Operation::INVALID, 0, 0 };
+    char command[8] = {};
+    long long key = 0;
+    long long value = 0;
+    const int fields = std::sscanf(line.c_str(), "%7s %lld %lld", command, &key, &value);
+    for (char* c = command; *c; c++) {
+        *c = (char)std::toupper((unsigned char)*c);
+    }
+
+    const bool validKey = fields >= 2 && key >= 0 && key <= (long long)MAX_KEY_VALUE;
+    const bool validValue = fields == 3 && value >= (long long)std::numeric_limits<DATA_TYPE>::min() &&
+                            value <= (long long)std::numeric_limits<DATA_TYPE>::max();
+    if (fields == 1 && std::strcmp(command, "PING") == 0) request.operation = Operation::PING;
+    if (fields == 2 && validKey && std::strcmp(command, "GET") == 0) request.operation = Operation::GET;
+    if (fields == 2 && validKey && std::strcmp(command, "DEL") == 0) request.operation = Operation::DEL;
+    if (validValue && validKey && std::strcmp(command, "SET") == 0) request.operation = Operation::SET;
+    request.key = (uint32_t)key;
+    request.value = (DATA_TYPE)value;
+    return request;
+}
+
+/**
+ * @brief Runs one request against the table and appends its reply line.
+ *
+ * SET replaces an existing value in place and only writes a new entry when the key is
+ * absent, since MemoryManager::write does not check for duplicates. A SET that fails
+ * therefore leaves the table unchanged.
+ */
+void Server::execute(const Request& request, std::string& reply) {
+    switch (request.operation) {
+    case Operation::SET:
+        if (manager.update(request.key, request.value) || manager.write(request.key, request.value)) {
+            reply += "+OK\r\n";
+        } else {
+            reply += "-ERR table full\r\n";
+        }
+        break;
+    case Operation::GET: {
+        const std::optional<DATA_TYPE> value = manager.find(request.key);
+        reply += value.has_value() ? ":" + std::to_string(value.value()) + "\r\n" : "$-1\r\n";
+        break;
+    }
+    case Operation::DEL:
+        reply += manager.erase(request.key) ? ":1\r\n" : ":0\r\n";
+        break;
+    case Operation::PING:
+        reply += "+PONG\r\n";
+        break;
+    case Operation::INVALID:
+        reply += "-ERR invalid command\r\n";
+        break;
+    case Operation::LINE_TOO_LONG:
+        reply += "-ERR line too long\r\n";
+        break;
+    }
+}
+
+/**
+ * @brief Writes as much pending output as the socket accepts.
+ *
+ * If the socket buffer fills up, the connection waits for EPOLLOUT before the rest is sent.
+ * A write error closes the connection, pending replies included.
+ */
+void Server::flush(const int fd, Connection& connection) {
+    size_t written = 0;
+    while (written < connection.output.size()) {
+        const ssize_t count = ::write(fd, connection.output.data() + written, connection.output.size() - written);
+        if (count > 0) {
+            written += count;
+            continue;
+        }
+        if (count < 0 && errno == EINTR) continue;
+        if (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK) connection.closing = true;
+        break;
+    }
+    connection.output.erase(0, written);
+    if (!connection.closing) watch(fd, connection);
+}
+
+/**
+ * @brief Registers the events the connection currently waits for.
+ *
+ * EPOLLOUT while replies are pending. EPOLLIN, and EPOLLRDHUP with it, only while the
+ * connection still accepts requests and its pending output is below OUTPUT_HIGH_WATER,
+ * so that a client not reading its replies is not read either.
+ */
+void Server::watch(const int fd, Connection& connection) {
+    const bool reading = !connection.draining && connection.output.size() < OUTPUT_HIGH_WATER;
+    const uint32_t events = (reading ? EPOLLIN | EPOLLRDHUP : 0) | (connection.output.empty() ? 0 : EPOLLOUT);
+    if (events == connection.events) return;
+
+    epoll_event event{};
+    event.events = events;
+    event.data.fd = fd;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+    connection.events = events;
+}
+
+int Server::run() {
+    std::vector<epoll_event> events(MAX_EVENTS);
+    std::vector<int> touched;
+    while (running) {
+        const int ready = epoll_wait(epollFd, events.data(), MAX_EVENTS, 100);
+        if (ready < 0 && errno != EINTR) return 1;
+
+        batch.clear();
+        touched.clear();
+        for (int i = 0; i < ready; i++) {
+            const int fd = events[i].data.fd;
+            bool isListener = false;
+            for (int listener : listeners) {
+                isListener |= listener == fd;
+            }
+            if (isListener) {
+                accept(fd);
+                continue;
+            }
+
+            auto it = connections.find(fd);
+            if (it == connections.end()) continue;
+            const bool readable = events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR);
+            if (readable && (it->second.events & EPOLLIN)) {
+                read(fd, it->second);
+            }
+            touched.push_back(fd);
+        }
+
+        // Execute every request gathered in this iteration, in arrival order per connection
+        for (const Request& request : batch) {
+            execute(request, connections[request.fd].output);
+        }
+
+        for (int fd : touched) {
+            Connection& connection = connections[fd];
+            flush(fd, connection);
+            if (connection.closing || (connection.draining && connection.output.empty())) {
+                close(fd);
+                connections.erase(fd);
+            }
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    int port = DEFAULT_PORT;
+    std::string unixPath = DEFAULT_UNIX_PATH;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--port") == 0) port = std::atoi(argv[i + 1]);
+        if (std::strcmp(argv[i], "--unix") == 0) unixPath = argv[i + 1];
+    }
+
+    std::signal(SIGINT, stop);
+    std::signal(SIGTERM, stop);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    Server server(MemoryManager<DATA_TYPE>::getInstance());
+    if (!server.listenTcp(port)) {
+        std::cerr << "Error: cannot listen on 127.0.0.1:" << port << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    if (!server.listenUnix(unixPath)) {
+        std::cerr << "Error: cannot listen on " << unixPath << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+
+    std::cout << "Listening on 127.0.0.1:" << port << " and " << unixPath << std::endl;
+    return server.run();
+}